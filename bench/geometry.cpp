@@ -0,0 +1,128 @@
+#include <random>
+#include <vector>
+#include <cmath>
+#include "harness.hpp"
+#include "../common/math.hpp"
+#include "../common/polygon.hpp"
+#include "../common/region.hpp"
+#include "../common/spatial_hash.hpp"
+
+using namespace common;
+using float2 = geom::vector<float,2>;
+using range2f = support::range<float2>;
+
+constexpr size_t count = 1 << 16;
+
+polygon make_circle(float2 center, float radius, size_t vertex_count)
+{
+	polygon circle;
+	for(size_t i = 0; i < vertex_count; ++i)
+		circle.vertices.push_back({center + rotate(float2::i(radius), protractor<12>::tau(float(i) / vertex_count)), float2::zero()});
+	update_normals(circle);
+	return circle;
+}
+
+int main(int argc, char* argv[])
+{
+	bench::suite suite("geometry", argc, argv);
+	std::mt19937 random(1234);
+	std::uniform_real_distribution<float> unit(0, 1);
+
+	std::vector<float2> points(count);
+	for(auto&& point : points)
+		point = float2(unit(random), unit(random));
+
+	// about the shape of bunny's nose
+	const auto nose = make_circle(float2::one(.5f), .2f, 64);
+	std::vector<char> inside(count);
+
+	suite.run("convex_contains", count, [&]()
+	{
+		for(size_t i = 0; i < count; ++i)
+			inside[i] = convex_contains(nose, points[i]);
+		bench::keep(inside);
+	});
+	{
+		size_t hits = 0;
+		for(auto&& point : points)
+			if(quadrance(point - float2::one(.5f)) < .19f * .19f)
+				hits += !convex_contains(nose, point);
+		suite.check(hits == 0, "convex_contains contains the inscribed circle");
+	}
+
+	{
+		region_grid<> grid({float2::zero(), float2::one()}, {64,64});
+		grid.add(range2f(nose), classify(nose));
+		const auto exact = [&nose](float2 point) { return convex_contains(nose, point); };
+
+		std::vector<char> grid_inside(count);
+		suite.run("region_grid::contains", count, [&]()
+		{
+			for(size_t i = 0; i < count; ++i)
+				grid_inside[i] = grid.contains(points[i], exact);
+			bench::keep(grid_inside);
+		});
+		suite.check(grid_inside == inside, "region_grid agrees with convex_contains");
+	}
+
+	{
+		std::vector<float2> directions(count);
+		for(auto&& direction : directions)
+			direction = (float2(unit(random), unit(random)) - .5f) * .05f;
+		std::vector<char> hits(count);
+		suite.run("segment_circle_intersects", count, [&]()
+		{
+			for(size_t i = 0; i < count; ++i)
+				hits[i] = segment_circle_intersects(points[i], directions[i], float2::one(.5f), .1f);
+			bench::keep(hits);
+		});
+	}
+
+	thread_pool jobs;
+	const range2f bounds{float2::zero(), float2::one(1000)};
+	constexpr size_t body_count = 100'000;
+	lanes<float> positions;
+	for(size_t i = 0; i < body_count; ++i)
+		positions.push_back(float2(unit(random), unit(random)) * 1000);
+
+	spatial_hash<> hash(bounds, 10);
+	suite.run("spatial_hash::build/100k", body_count, [&]()
+	{
+		hash.build(positions, jobs);
+	});
+
+	constexpr size_t query_count = 1000;
+	constexpr float query_radius = 8;
+	constexpr float item_radius = 2;
+	std::vector<unsigned> found(query_count);
+	suite.run("spatial_hash::query_circles/100k", query_count, [&]()
+	{
+		for(size_t q = 0; q < query_count; ++q)
+		{
+			found[q] = 0;
+			hash.query_circles(positions, item_radius, positions[q], query_radius, [&](size_t)
+			{
+				++found[q];
+			});
+		}
+		bench::keep(found);
+	});
+
+	// brute force, wrapping around the edges
+	bool agree = true;
+	for(size_t q = 0; q < query_count && agree; ++q)
+	{
+		unsigned expected = 0;
+		for(size_t i = 0; i < body_count; ++i)
+		{
+			auto difference = positions[i] - positions[q];
+			difference.x() -= 1000 * std::round(difference.x() / 1000);
+			difference.y() -= 1000 * std::round(difference.y() / 1000);
+			expected += quadrance(difference) < (query_radius + item_radius) * (query_radius + item_radius);
+		}
+		agree = expected == found[q];
+	}
+	suite.check(agree, "spatial_hash agrees with brute force");
+
+	return suite.report();
+}
@@ -0,0 +1,189 @@
+#ifndef BENCH_HARNESS_HPP
+#define BENCH_HARNESS_HPP
+#include <chrono>
+#include <array>
+#include <vector>
+#include <string>
+#include <utility>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// the build passes in the commit, so that results can be told apart
+#if !defined BENCH_COMMIT
+#define BENCH_COMMIT "unknown"
+#endif
+
+namespace bench
+{
+
+// pretend to use the value, so that the computation isn't optimized away
+template <typename T>
+inline void keep(const T& value)
+{
+#if defined __GNUC__
+	asm volatile("" : : "g"(&value) : "memory");
+#else
+	static const volatile void* sink;
+	sink = &value;
+#endif
+}
+
+// each run is a number of repetitions of a function, after a few warmup calls,
+// the timings are per item the function goes through,
+// so that results of different sizes are still comparable
+//
+// human readable summary goes to stderr, json to stdout,
+// one result per line, so that it's easy to diff or grep
+//
+// options:
+// -r <count> repetitions
+// -w <count> warmup calls
+// -f <substring> only run the benchmarks with names containing it
+class suite
+{
+	public:
+	using clock = std::chrono::steady_clock;
+
+	suite(const char* name, int argc, const char* const* argv) : name(name)
+	{
+		for(int i = 1; i < argc; ++i)
+		{
+			const bool has_value = i + 1 < argc;
+			if(has_value && std::strcmp(argv[i], "-r") == 0)
+				repetitions = std::max(std::atoi(argv[++i]), 1);
+			else if(has_value && std::strcmp(argv[i], "-w") == 0)
+				warmup = std::max(std::atoi(argv[++i]), 0);
+			else if(has_value && std::strcmp(argv[i], "-f") == 0)
+				filter = argv[++i];
+			else
+			{
+				std::fprintf(stderr, "usage: %s [-r repetitions] [-w warmup] [-f filter]\n", argv[0]);
+				std::exit(2);
+			}
+		}
+	}
+
+	template <typename Function>
+	suite& run(const std::string& name, size_t items, Function&& function)
+	{
+		skipping = name.find(filter) == std::string::npos;
+		if(skipping)
+			return *this;
+
+		for(int i = 0; i < warmup; ++i)
+			function();
+
+		std::vector<double> samples;
+		samples.reserve(repetitions);
+		for(int i = 0; i < repetitions; ++i)
+		{
+			const auto start = clock::now();
+			function();
+			const auto elapsed = std::chrono::duration<double, std::nano>(clock::now() - start);
+			samples.push_back(elapsed.count() / std::max(items, size_t{1}));
+		}
+		std::sort(samples.begin(), samples.end());
+
+		result r{name, items, {}, {}};
+		r.stats =
+		{
+			samples.front(),
+			percentile(samples, .1),
+			percentile(samples, .5),
+			percentile(samples, .9),
+			samples.back()
+		};
+		std::fprintf(stderr, "%-48s %12.3f ns/item  (p10 %.3f, p90 %.3f)\n",
+			name.c_str(), r.stats[2], r.stats[1], r.stats[3]);
+		results.push_back(std::move(r));
+		return *this;
+	}
+
+	// extra numbers attached to the last run, approximation error for example
+	suite& metric(const std::string& name, double value)
+	{
+		if(skipping || results.empty())
+			return *this;
+		std::fprintf(stderr, "%-48s %12.6g\n", ("  " + name).c_str(), value);
+		results.back().metrics.emplace_back(name, value);
+		return *this;
+	}
+
+	// comparisons against reference implementations,
+	// any failure makes the whole suite fail
+	bool check(bool condition, const std::string& what)
+	{
+		if(!condition)
+		{
+			std::fprintf(stderr, "FAILED: %s\n", what.c_str());
+			failures.push_back(what);
+		}
+		return condition;
+	}
+
+	int report() const
+	{
+		std::printf("{\n");
+		std::printf("\"suite\": \"%s\",\n", escape(name).c_str());
+		std::printf("\"commit\": \"%s\",\n", BENCH_COMMIT);
+		std::printf("\"repetitions\": %d,\n", repetitions);
+		std::printf("\"results\": [\n");
+		for(size_t i = 0; i < results.size(); ++i)
+		{
+			const auto& r = results[i];
+			std::printf("{\"name\": \"%s\", \"items\": %zu, \"min\": %.4f, \"p10\": %.4f, \"median\": %.4f, \"p90\": %.4f, \"max\": %.4f",
+				escape(r.name).c_str(), r.items, r.stats[0], r.stats[1], r.stats[2], r.stats[3], r.stats[4]);
+			for(auto&& [metric, value] : r.metrics)
+				std::printf(", \"%s\": %.9g", escape(metric).c_str(), value);
+			std::printf("}%s\n", i + 1 < results.size() ? "," : "");
+		}
+		std::printf("],\n");
+		std::printf("\"failures\": [");
+		for(size_t i = 0; i < failures.size(); ++i)
+			std::printf("%s\"%s\"", i ? ", " : "", escape(failures[i]).c_str());
+		std::printf("]\n");
+		std::printf("}\n");
+		return failures.empty() ? 0 : 1;
+	}
+
+	private:
+	struct result
+	{
+		std::string name;
+		size_t items;
+		// min, p10, median, p90, max
+		std::array<double,5> stats;
+		std::vector<std::pair<std::string, double>> metrics;
+	};
+
+	std::string name;
+	int repetitions = 31;
+	int warmup = 3;
+	std::string filter;
+	bool skipping = false;
+	std::vector<result> results;
+	std::vector<std::string> failures;
+
+	static double percentile(const std::vector<double>& sorted, double fraction)
+	{
+		return sorted[size_t(fraction * (sorted.size() - 1) + .5)];
+	}
+
+	static std::string escape(const std::string& text)
+	{
+		std::string escaped;
+		for(char c : text)
+		{
+			if(c == '"' || c == '\\')
+				escaped += '\\';
+			escaped += c;
+		}
+		return escaped;
+	}
+};
+
+} // namespace bench
+
+#endif /* end of include guard */
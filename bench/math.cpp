@@ -0,0 +1,216 @@
+#include <random>
+#include <vector>
+#include <cmath>
+#include "harness.hpp"
+#include "../common/math.hpp"
+
+using namespace common;
+using float2 = geom::vector<float,2>;
+
+constexpr size_t count = 1 << 16;
+const float pi = std::acos(-1.f);
+
+std::vector<float> random_factors(std::mt19937& random)
+{
+	std::uniform_real_distribution<float> factor(0, 1);
+	std::vector<float> factors(count);
+	for(auto&& f : factors)
+		f = std::min(factor(random), std::nextafter(1.f, 0.f));
+	return factors;
+}
+
+std::vector<float2> random_vectors(std::mt19937& random)
+{
+	std::uniform_real_distribution<float> coordinate(-100, 100);
+	std::vector<float2> vectors(count);
+	for(auto&& v : vectors)
+		v = float2(coordinate(random), coordinate(random));
+	return vectors;
+}
+
+float max_distance(const std::vector<float2>& a, const std::vector<float2>& b)
+{
+	float result = 0;
+	for(size_t i = 0; i < a.size(); ++i)
+		result = std::max(result, support::root2(quadrance(a[i] - b[i])));
+	return result;
+}
+
+// protractor::tau approximates the half angle, the point at factor * pi on the unit circle
+template <size_t Exponent, interpolation Interpolation>
+void table_lookup(bench::suite& suite, const std::vector<float>& factors, const char* name)
+{
+	using protractor = common::protractor<Exponent>;
+	std::vector<float2> directions(factors.size());
+	const auto factor_range = support::make_range(factors.data(), factors.data() + factors.size());
+	protractor::table(); // make the table outside of the timing
+
+	suite.run(name, factors.size(), [&]()
+	{
+		protractor::template tau<Interpolation>(factor_range, directions.data());
+		bench::keep(directions);
+	});
+
+	float error = 0;
+	for(size_t i = 0; i < factors.size(); ++i)
+	{
+		const auto exact = float2(std::cos(factors[i] * pi), std::sin(factors[i] * pi));
+		error = std::max(error, support::root2(quadrance(directions[i] - exact)));
+		suite.check(quadrance(directions[i] - protractor::template tau<Interpolation>(factors[i])) == 0,
+			std::string(name) + " batch matches scalar");
+	}
+	suite.metric("max_error", error);
+}
+
+int main(int argc, char* argv[])
+{
+	bench::suite suite("math", argc, argv);
+	std::mt19937 random(1234);
+	const auto factors = random_factors(random);
+	const auto vectors = random_vectors(random);
+	const auto vector_range = support::make_range(vectors.data(), vectors.data() + vectors.size());
+	std::vector<float2> out(count);
+	std::vector<float2> reference(count);
+
+	suite.run("sin_cos", count, [&]()
+	{
+		for(size_t i = 0; i < count; ++i)
+			out[i] = float2(std::cos(factors[i] * pi), std::sin(factors[i] * pi));
+		bench::keep(out);
+	});
+
+	table_lookup<3, interpolation::linear>(suite, factors, "protractor<3>::tau");
+	table_lookup<3, interpolation::hermite>(suite, factors, "protractor<3>::tau<hermite>");
+	table_lookup<8, interpolation::linear>(suite, factors, "protractor<8>::tau");
+	table_lookup<8, interpolation::hermite>(suite, factors, "protractor<8>::tau<hermite>");
+	table_lookup<12, interpolation::linear>(suite, factors, "protractor<12>::tau");
+	table_lookup<16, interpolation::linear>(suite, factors, "protractor<16>::tau");
+
+	const auto half_angle = protractor<12>::tau(factors[0]);
+
+	suite.run("rotate", count, [&]()
+	{
+		for(size_t i = 0; i < count; ++i)
+			reference[i] = rotate(vectors[i], half_angle);
+		bench::keep(reference);
+	});
+
+	suite.run("rotate_batch", count, [&]()
+	{
+		rotate(vector_range, half_angle, out.data());
+		bench::keep(out);
+	});
+	suite.check(max_distance(out, reference) < 1e-3f, "rotate_batch matches rotate");
+
+	suite.run("rotor", count, [&]()
+	{
+		const rotor<> rotation(half_angle);
+		for(size_t i = 0; i < count; ++i)
+			out[i] = rotation(vectors[i]);
+		bench::keep(out);
+	});
+	suite.check(max_distance(out, reference) < 1e-3f, "rotor matches rotate");
+
+	{
+		std::vector<float> x(count), y(count);
+		for(size_t i = 0; i < count; ++i)
+		{
+			x[i] = vectors[i].x();
+			y[i] = vectors[i].y();
+		}
+		suite.run("rotate_lanes", count, [&]()
+		{
+			rotate(count, x.data(), y.data(), half_angle, x.data(), y.data());
+			bench::keep(x);
+			bench::keep(y);
+		});
+	}
+
+	suite.run("rotor_compose", count, [&]()
+	{
+		rotor<> rotation;
+		const auto step = rotor<>::tau<12>(factors[1]);
+		for(size_t i = 0; i < count; ++i)
+			rotation *= step;
+		bench::keep(rotation);
+	});
+	{
+		const float a = .2f, b = .3f;
+		const auto composed = rotor<>::tau<12>(a) * rotor<>::tau<12>(b);
+		const auto direct = rotor<>::tau<12>(a + b);
+		suite.check(support::abs(composed.cos() - direct.cos()) < 1e-4f &&
+			support::abs(composed.sin() - direct.sin()) < 1e-4f, "rotors compose");
+		const auto identity = composed * composed.inverse();
+		suite.check(support::abs(identity.cos() - 1) < 1e-5f, "rotor inverse");
+	}
+
+	suite.run("normalize", count, [&]()
+	{
+		for(size_t i = 0; i < count; ++i)
+			reference[i] = normalize(vectors[i]);
+		bench::keep(reference);
+	});
+
+	suite.run("normalize_batch", count, [&]()
+	{
+		normalize(vector_range, out.data());
+		bench::keep(out);
+	});
+	suite.check(max_distance(out, reference) < 1e-5f, "normalize_batch matches normalize");
+
+	const auto surface = vectors[2];
+
+	suite.run("project", count, [&]()
+	{
+		for(size_t i = 0; i < count; ++i)
+			reference[i] = project(vectors[i], surface);
+		bench::keep(reference);
+	});
+
+	suite.run("project_batch", count, [&]()
+	{
+		project(vector_range, surface, out.data());
+		bench::keep(out);
+	});
+	suite.check(max_distance(out, reference) < 1e-3f, "project_batch matches project");
+
+	reject(vector_range, surface, out.data());
+	for(size_t i = 0; i < count; ++i)
+		reference[i] = reject(vectors[i], surface);
+	suite.check(max_distance(out, reference) < 1e-3f, "reject_batch matches reject");
+
+	suite.run("reflect", count, [&]()
+	{
+		for(size_t i = 0; i < count; ++i)
+			reference[i] = reflect(vectors[i], surface);
+		bench::keep(reference);
+	});
+
+	suite.run("reflect_batch", count, [&]()
+	{
+		reflect(vector_range, surface, out.data());
+		bench::keep(out);
+	});
+	suite.check(max_distance(out, reference) < 1e-3f, "reflect_batch matches reflect");
+
+	std::vector<float> distances(count);
+	suite.run("mod_distance", count, [&]()
+	{
+		for(size_t i = 0; i < count; ++i)
+			distances[i] = mod_distance(factors[i], factors[count - 1 - i], 1.f);
+		bench::keep(distances);
+	});
+
+	suite.run("mod_difference", count, [&]()
+	{
+		for(size_t i = 0; i < count; ++i)
+			distances[i] = mod_difference(factors[i], factors[count - 1 - i], 1.f);
+		bench::keep(distances);
+	});
+	suite.check(support::abs(mod_distance(.1f, .9f, 1.f) - .2f) < 1e-6f, "mod_distance wraps");
+	suite.check(support::abs(mod_difference(.9f, .1f, 1.f) - .2f) < 1e-6f, "mod_difference forward across the wrap");
+	suite.check(support::abs(mod_difference(.1f, .9f, 1.f) + .2f) < 1e-6f, "mod_difference backward across the wrap");
+	suite.check(support::abs(mod_difference(.3f, .4f, 1.f) - .1f) < 1e-6f, "mod_difference without wrap");
+
+	return suite.report();
+}
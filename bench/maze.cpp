@@ -0,0 +1,225 @@
+// circular_maze without a window, what it costs to generate one,
+// to move around in it, to find a way out of it and to build a frame of it, small to big,
+// and walking out through an endless one
+#define SIMPLE_VG_RECORD
+#include <random>
+#include <vector>
+#include <string>
+#include <optional>
+#include <thread>
+#include <algorithm>
+#include <cmath>
+#include "harness.hpp"
+#include "../common/simple_vg.h"
+#include "../common/simple_vg.cpp"
+#include "../common/circular_maze.hpp"
+
+using namespace simple;
+using namespace simple::vg;
+using namespace common;
+
+const float2 size(800,600);
+const double pi = std::acos(-1.);
+
+int main(int argc, char* argv[])
+{
+	bench::suite suite("maze", argc, argv);
+	std::mt19937 random(1234);
+	const auto uniform = [&random](rangef range)
+	{
+		return std::uniform_real_distribution<float>(range.lower(), range.upper())(random);
+	};
+	canvas canvas(canvas::flags::antialias | canvas::flags::stencil_strokes);
+	auto& stats = canvas.recorder().stats;
+
+	for(int layers : {10, 100, 400})
+	{
+		const auto name = "/layers=" + std::to_string(layers);
+
+		std::optional<circular_maze> generated;
+		suite.run("generate" + name, 1, [&]()
+		{
+			generated.emplace(size, layers, uniform);
+		});
+		auto& maze = *generated;
+		suite.metric("walls", maze.get_walls().size())
+			.metric("paths", maze.get_paths().size());
+
+		// back and forth in the middle, bumping into walls along the way
+		constexpr int moves = 10000;
+		maze.player_level = layers / 2;
+		suite.run("circular_move" + name, moves, [&]()
+		{
+			for(int i = 0; i < moves; ++i)
+				maze.circular_move(i % 2000 < 1000 ? 7 : -5);
+			bench::keep(maze.current_angle);
+		});
+
+		// against going over all the walls of the level, with the distance from the player
+		// worked out with trig, skipping the angles too close to call
+		const double corridor = maze.get_corridor_radius();
+		const double radius = corridor * (2 + maze.player_level);
+		const auto level_walls = maze.walls_of(maze.player_level);
+		bool same = true;
+		for(int i = 0; i < 1000; ++i)
+		{
+			const auto angle = uniform({0, 1});
+			bool hit = false, close_call = false;
+			for(auto wall : level_walls)
+			{
+				const double turns = mod_distance(support::wrap(angle + wall, 1.f), 3/4.f, 1.f);
+				const double distance = 2 * radius * std::sin(turns * pi);
+				hit = hit || distance < corridor / 2;
+				close_call = close_call || std::abs(distance - corridor / 2) < corridor / 1000;
+			}
+			same = same && (close_call || hit == bool(maze.wall_hit_test(angle)));
+		}
+		suite.check(same, "wall hit test" + name + " finds the same walls as going over all of them");
+
+		maze.player_level = -1;
+		bool solvable = false;
+		suite.run("route" + name, 1, [&]()
+		{
+			solvable = maze.route(layers - 1).has_value();
+		});
+		suite.metric("solvable", solvable);
+		maze.player_level = layers / 2;
+
+		suite.run("draw" + name, 1, [&]()
+		{
+			canvas.clear();
+			auto frame = canvas.begin_frame(size);
+			maze.draw(frame);
+		});
+		stats = {};
+		{ auto frame = canvas.begin_frame(size);
+			maze.draw(frame);
+		}
+		suite.metric("draw_calls", stats.draw_calls())
+			.metric("vertices", stats.vertices);
+	}
+
+	// against flooding the corridors a small step at a time, going through paths where the hit test finds them,
+	// and following the routes with hit tests all the way
+	{
+		const int layers = 7;
+		const int steps = 2000;
+		bool same = true, followed = true;
+		int solvable = 0;
+		for(int i = 0; i < 50; ++i)
+		{
+			circular_maze maze(size, layers, uniform);
+			std::vector<char> flooded((layers + 1) * steps, 0);
+			std::vector<std::pair<int, int>> queue;
+			for(int step = 0; step < steps; ++step)
+			{
+				flooded[step] = true;
+				queue.emplace_back(-1, step);
+			}
+			bool reached = false;
+			for(std::size_t next = 0; next < queue.size() && !reached; ++next)
+			{
+				const auto [level, step] = queue[next];
+				reached = level == layers - 1;
+				const auto flood = [&](int level, int step)
+				{
+					step = (step + steps) % steps;
+					if(!flooded[(level + 1) * steps + step])
+					{
+						flooded[(level + 1) * steps + step] = true;
+						queue.emplace_back(level, step);
+					}
+				};
+				maze.player_level = level;
+				for(int direction : {-1, +1})
+				{
+					if(level < 0 || !maze.wall_hit_test(float((step + direction + steps) % steps) / steps))
+						flood(level, step + direction);
+					if(level + direction >= -1 && level + direction < layers
+						&& maze.path_hit_test(float(step) / steps, level, direction))
+						flood(level + direction, step);
+				}
+			}
+			maze.player_level = -1;
+			maze.current_angle = uniform({0, 1});
+			const auto route = maze.route(layers - 1);
+			same = same && reached == route.has_value();
+			solvable += route.has_value();
+			if(!route)
+				continue;
+
+			for(auto movement : *route)
+			{
+				const auto target = support::wrap(3/4.f - movement.path, 1.f);
+				const auto turn = mod_difference(maze.current_angle, target, 1.f);
+				for(int step = 1; step <= steps; ++step)
+					followed = followed && !maze.wall_hit_test(support::wrap(maze.current_angle + turn * step / steps, 1.f));
+				maze.current_angle = target;
+				if(movement.level != maze.player_level)
+				{
+					const float direction = movement.level - maze.player_level;
+					followed = followed && std::abs(direction) == 1
+						&& maze.path_hit_test(maze.current_angle, maze.player_level, direction);
+					maze.player_level = movement.level;
+				}
+			}
+			followed = followed && maze.player_level == layers - 1;
+		}
+		suite.check(same, "ring graph finds the same mazes solvable as flooding them");
+		suite.check(followed, "routes only go through paths, and never through walls");
+		std::fprintf(stderr, "%d of 50 mazes of %d layers solvable\n", solvable, layers);
+	}
+
+	{
+		const int layers = 7;
+		auto maze = circular_maze::endless(size, layers, 1234);
+		maze.player_level = 0;
+		const auto walk = [&]()
+		{
+			maze.player_level += 0.2f;
+			canvas.clear();
+			auto frame = canvas.begin_frame(size);
+			maze.draw(frame);
+			maze.circular_move(7);
+		};
+		suite.run("endless/draw", 1, walk);
+
+		// at about a frame every millisecond, going out a level every five frames,
+		// which leaves the background thread just enough time for the far levels
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+		const auto misses = maze.misses();
+		std::size_t most_kept = 0;
+		double slowest = 0;
+		for(int i = 0; i < 1000; ++i)
+		{
+			const auto start = bench::suite::clock::now();
+			walk();
+			// the autopilot asks for a way a screen further out every so often
+			if(i % 25 == 0)
+				maze.route(int(maze.player_level) + layers);
+			slowest = std::max(slowest, std::chrono::duration<double, std::milli>(bench::suite::clock::now() - start).count());
+			most_kept = std::max(most_kept, maze.levels_kept());
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		suite.metric("level", maze.player_level)
+			.metric("slowest_frame_ms", slowest)
+			.metric("most_levels_kept", most_kept)
+			.metric("misses", maze.misses() - misses);
+		suite.check(most_kept <= 3 * (layers + 2), "endless maze keeps a bounded number of levels");
+		suite.check(maze.misses() == misses, "endless maze has levels ready by the time they come into view");
+
+		auto again = circular_maze::endless(size, layers, 1234);
+		bool same = true;
+		for(int level : {0, 1, int(maze.player_level)})
+		{
+			const auto walls = maze.walls_of(level), walls_again = again.walls_of(level);
+			const auto paths = maze.paths_of(level), paths_again = again.paths_of(level);
+			same = same
+				&& std::equal(walls.begin(), walls.end(), walls_again.begin(), walls_again.end())
+				&& std::equal(paths.begin(), paths.end(), paths_again.begin(), paths_again.end());
+		}
+		suite.check(same, "endless maze makes the same levels from the same seed");
+	}
+
+	return suite.report();
+}
@@ -0,0 +1,53 @@
+#include <array>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include "harness.hpp"
+#include "../common/mixer.hpp"
+
+using duration = std::chrono::duration<float>;
+using wave = common::wave<duration>;
+
+constexpr size_t samples = 44100;
+const float tau = 2 * std::acos(-1.f);
+
+int main(int argc, char* argv[])
+{
+	bench::suite suite("mixer", argc, argv);
+	const auto tick = duration(1.f/samples);
+	std::vector<unsigned char> buffer(samples);
+
+	// the sketchbook has 32 channels
+	std::array<wave, 32> waves{};
+	const auto start_all = [&]()
+	{
+		for(size_t i = 0; i < waves.size(); ++i)
+			waves[i] = {[i](float ratio) { return std::sin(ratio * tau * (i + 1) * 100) / 32; }, duration(10), duration(10)};
+	};
+
+	suite.run("mix/silence", samples, [&]()
+	{
+		std::fill(buffer.begin(), buffer.end(), 0);
+		common::mix(waves, tick, buffer);
+		bench::keep(buffer);
+	});
+	suite.check(std::all_of(buffer.begin(), buffer.end(), [](auto v) { return v == 0; }),
+		"nothing playing leaves silence");
+
+	suite.run("mix/32", samples, [&]()
+	{
+		start_all();
+		std::fill(buffer.begin(), buffer.end(), 0);
+		common::mix(waves, tick, buffer);
+		bench::keep(buffer);
+	});
+
+	{
+		std::array<wave, 1> one{{ {[](float) { return 2.f; }, duration(1), duration(1)} }};
+		std::vector<unsigned char> clipped(4, 0);
+		common::mix(one, tick, clipped);
+		suite.check(clipped[0] == 127, "mix clips");
+	}
+
+	return suite.report();
+}
@@ -0,0 +1,104 @@
+#include <random>
+#include <vector>
+#include "harness.hpp"
+#include "../common/particles.hpp"
+#include "../common/parallel.hpp"
+#include "../common/pool.hpp"
+
+using namespace common;
+using float2 = geom::vector<float,2>;
+
+constexpr size_t count = 1'000'000;
+
+int main(int argc, char* argv[])
+{
+	bench::suite suite("particles", argc, argv);
+	std::mt19937 random(1234);
+	std::uniform_real_distribution<float> unit(0, 1);
+
+	const support::range<float2> bounds{float2::zero(), float2::one(1000)};
+	particles<> bodies;
+	bodies.reserve(count);
+	for(size_t i = 0; i < count; ++i)
+		bodies.push_back(float2(unit(random), unit(random)) * 1000,
+			float2(unit(random), unit(random)) - .5f,
+			(float2(unit(random), unit(random)) - .5f) * .01f);
+
+	suite.run("integrate/1M", count, [&]() { bodies.integrate(); });
+	suite.run("drag/1M", count, [&]() { bodies.drag(.01f); });
+	suite.run("wrap/1M", count, [&]() { bodies.wrap(bounds); });
+	{
+		bool wrapped = true;
+		for(size_t i = 0; i < count; ++i)
+		{
+			const auto p = bodies.position[i];
+			wrapped = wrapped &&
+				bounds.lower().x() <= p.x() && p.x() < bounds.upper().x() &&
+				bounds.lower().y() <= p.y() && p.y() < bounds.upper().y();
+		}
+		suite.check(wrapped, "wrap keeps everything in bounds");
+	}
+
+	// the whole frame update, split between a growing number of threads,
+	// doubling up to all cores, and then all of them if that's not a power of two
+	const unsigned cores = thread_pool::default_size();
+	for(unsigned threads = 1; ; threads = std::min(threads * 2, cores))
+	{
+		thread_pool jobs(threads);
+		suite.run("update/1M/threads=" + std::to_string(threads), count, [&]()
+		{
+			jobs.parallel_for(0, count, [&](size_t first, size_t last)
+			{
+				bodies.integrate({first, last});
+				bodies.drag(.01f, {first, last});
+				bodies.wrap(bounds, {first, last});
+			});
+		});
+		if(threads == cores)
+			break;
+	}
+
+	{
+		thread_pool jobs;
+		constexpr size_t calls = 1000;
+		suite.run("parallel_for/empty", calls, [&]()
+		{
+			for(size_t i = 0; i < calls; ++i)
+				jobs.parallel_for(0, jobs.size() * 8, [](size_t, size_t) {});
+		});
+
+		std::vector<unsigned> visits(count);
+		jobs.parallel_for(0, count, 7, [&](size_t first, size_t last)
+		{
+			for(size_t i = first; i < last; ++i)
+				++visits[i];
+		});
+		suite.check(std::all_of(visits.begin(), visits.end(), [](auto v) { return v == 1; }),
+			"parallel_for visits every index once");
+	}
+
+	{
+		constexpr size_t objects = 100'000;
+		std::vector<pool<int>::handle> handles(objects);
+		pool<int> objects_pool;
+		suite.run("pool::emplace_erase", objects, [&]()
+		{
+			for(size_t i = 0; i < objects; ++i)
+				handles[i] = objects_pool.emplace(int(i));
+			for(size_t i = 0; i < objects; ++i)
+				objects_pool.erase(handles[i]);
+		});
+		suite.check(objects_pool.empty() && !objects_pool.contains(handles[0]), "pool erases");
+	}
+
+	suite.run("push_back_erase/100k", 100'000, [&]()
+	{
+		particles<> spawned;
+		for(size_t i = 0; i < 100'000; ++i)
+			spawned.push_back(float2::zero());
+		while(!spawned.empty())
+			spawned.erase(spawned.size() / 2);
+	});
+
+	return suite.report();
+}
@@ -0,0 +1,210 @@
+// simple_vg drawing on the CPU, what a frame costs on one thread and on all of them,
+// and a few pixels checked against what the GL backend would draw
+//
+// BENCH_SNAPSHOTS names a directory to save the last frame of each scene into, as png
+#define SIMPLE_VG_RASTER
+#include <random>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include "harness.hpp"
+#include "../common/simple_vg.h"
+#include "../common/simple_vg.cpp"
+#include "../common/parallel.hpp"
+#include "../common/png.hpp"
+
+using namespace simple;
+using namespace simple::vg;
+
+const float2 size(800,600);
+const float2 half_size = size/2;
+
+struct rgba { int r, g, b, a; };
+
+rgba pixel(const raster::rasterizer& rasterizer, int x, int y)
+{
+	const auto* p = rasterizer.pixels().data() + (std::size_t(y) * rasterizer.width() + x) * 4;
+	return {p[0], p[1], p[2], p[3]};
+}
+
+bool near(rgba actual, rgba expected, int tolerance = 1)
+{
+	return std::abs(actual.r - expected.r) <= tolerance
+		&& std::abs(actual.g - expected.g) <= tolerance
+		&& std::abs(actual.b - expected.b) <= tolerance
+		&& std::abs(actual.a - expected.a) <= tolerance;
+}
+
+int main(int argc, char* argv[])
+{
+	bench::suite suite("raster", argc, argv);
+	std::mt19937 random(1234);
+	std::uniform_real_distribution<float> unit(0, 1);
+
+	canvas canvas(canvas::flags::antialias | canvas::flags::stencil_strokes);
+	common::thread_pool one(1);
+	common::thread_pool all;
+	framebuffer pattern(canvas, int2(64,64));
+
+	const auto snapshot = [&](const raster::rasterizer& rasterizer, const char* name)
+	{
+		const char* directory = std::getenv("BENCH_SNAPSHOTS");
+		if(!directory)
+			return;
+		auto filename = std::string(directory) + "/" + name + ".png";
+		std::replace(filename.begin() + std::strlen(directory) + 1, filename.end(), '/', '_');
+		suite.check(common::write_png(filename.c_str(),
+			rasterizer.width(), rasterizer.height(), rasterizer.snapshot().data()),
+			"snapshot written");
+	};
+
+	std::vector<common::thread_pool*> pools{&one};
+	if(all.size() > 1)
+		pools.push_back(&all);
+
+	const auto scene = [&](const char* name, std::size_t items, auto&& draw)
+	{
+		for(auto* jobs : pools)
+		{
+			raster::rasterizer rasterizer(canvas.recorder(), *jobs);
+			suite.run(std::string(name) + "/threads=" + std::to_string(jobs->size()), items, [&]()
+			{
+				canvas.clear();
+				draw();
+			});
+			if(jobs == pools.back())
+				snapshot(rasterizer, name);
+		}
+	};
+
+	scene("clear", 1, [&]()
+	{
+		auto frame = canvas.begin_frame(size);
+	});
+
+	std::vector<float2> stars(1000);
+	for(auto& star : stars)
+		star = float2(unit(random), unit(random)) * size;
+	scene("fill/rectangles", stars.size(), [&]()
+	{
+		auto frame = canvas.begin_frame(size);
+		auto sketch = frame.begin_sketch();
+		for(auto star : stars)
+			sketch.rectangle({star, star + float2::one(8)});
+		sketch.fill(rgba_vector(0.2,0.3,0.8,0.5));
+	});
+
+	scene("fill/ellipses", stars.size(), [&]()
+	{
+		auto frame = canvas.begin_frame(size);
+		auto sketch = frame.begin_sketch();
+		for(auto star : stars)
+			sketch.ellipse({star - 10, star + 10});
+		sketch.fill(rgba_vector(0.8,0.3,0.2,0.5));
+	});
+
+	scene("stroke/lines", stars.size(), [&]()
+	{
+		auto frame = canvas.begin_frame(size);
+		auto sketch = frame.begin_sketch();
+		for(auto star : stars)
+			sketch.line(half_size, star);
+		sketch.line_width(1.5).outline(rgba_vector(0,0,0,1));
+	});
+
+	scene("fill/gradient", 1, [&]()
+	{
+		auto frame = canvas.begin_frame(size);
+		frame.begin_sketch()
+			.rectangle({float2::zero(), size})
+			.fill(paint::radial_gradient(half_size, {0, half_size.y()},
+				{rgba_vector(1,1,0,1), rgba_vector(0,0,1,1)}));
+	});
+
+	scene("fill/pattern", 1, [&]()
+	{
+		{ auto frame = canvas.begin_frame(pattern);
+			frame.begin_sketch()
+				.ellipse({float2::zero(), float2(pattern.size)})
+				.fill(rgba_vector(0,0.5,0,1));
+		}
+		auto frame = canvas.begin_frame(size);
+		frame.begin_sketch()
+			.rectangle({float2::zero(), size})
+			.fill(pattern.paint({int2::zero(), int2(200,150)}));
+	});
+
+	// pixels that are known in advance
+	{
+		raster::rasterizer rasterizer(canvas.recorder(), all);
+
+		{ auto frame = canvas.begin_frame(pattern);
+			frame.begin_sketch()
+				.ellipse({float2::zero(), float2(pattern.size)})
+				.fill(rgba_vector(0,0.5,0,1));
+		}
+		canvas.clear();
+		{ auto frame = canvas.begin_frame(size);
+			frame.begin_sketch()
+				.rectangle({float2(10,10), float2(20,20)})
+				.fill(rgba_vector(1,0,0,1));
+			frame.begin_sketch()
+				.rectangle({float2(30.5,10), float2(40,20)})
+				.fill(rgba_vector(1,0,0,1));
+			frame.begin_sketch()
+				.line({10,50}, {90,50})
+				.line_width(2).outline(rgba_vector(0,0,0,1));
+			frame.begin_sketch()
+				.rectangle({float2(100,0), float2(164,64)})
+				.fill(pattern.paint({int2(100,0), int2(164,64)}));
+		}
+		suite.check(near(pixel(rasterizer, 15,15), {255,0,0,255}), "inside a rectangle");
+		suite.check(near(pixel(rasterizer, 5,15), {255,255,255,255}), "outside a rectangle");
+		suite.check(near(pixel(rasterizer, 20,15), {255,255,255,255}), "rectangle bounds are exclusive");
+		suite.check(near(pixel(rasterizer, 30,15), {255,128,128,255}), "half a pixel is half covered");
+		suite.check(near(pixel(rasterizer, 50,49), {0,0,0,255}) && near(pixel(rasterizer, 50,50), {0,0,0,255}),
+			"two pixel wide line");
+		suite.check(near(pixel(rasterizer, 50,47), {255,255,255,255}), "next to a line");
+		suite.check(near(pixel(rasterizer, 132,32), {0,128,0,255}), "framebuffer pattern");
+		suite.check(near(pixel(rasterizer, 101,1), {255,255,255,255}), "framebuffer pattern corner");
+
+		// a translucent top half, upside down or premultiplied twice shows
+		{ auto frame = canvas.begin_frame(pattern);
+			frame.begin_sketch()
+				.rectangle({float2::zero(), float2(pattern.size) * float2(1,.5f)})
+				.fill(rgba_vector(1,0,0,.5f));
+		}
+		canvas.clear();
+		{ auto frame = canvas.begin_frame(size);
+			frame.begin_sketch()
+				.rectangle({float2(200,0), float2(264,64)})
+				.fill(pattern.paint({int2(200,0), int2(264,64)}));
+		}
+		suite.check(near(pixel(rasterizer, 232,16), {255,128,128,255}), "framebuffer pattern translucent top");
+		suite.check(near(pixel(rasterizer, 232,48), {255,255,255,255}), "framebuffer pattern clear bottom");
+
+		raster::rasterizer single(canvas.recorder(), one);
+		canvas.clear();
+		{ auto frame = canvas.begin_frame(size);
+			auto sketch = frame.begin_sketch();
+			for(auto star : stars)
+				sketch.line(half_size, star);
+			sketch.line_width(1.5).outline(rgba_vector(0,0,0,1));
+		}
+		const auto lines = single.pixels();
+		raster::rasterizer again(canvas.recorder(), all);
+		canvas.clear();
+		{ auto frame = canvas.begin_frame(size);
+			auto sketch = frame.begin_sketch();
+			for(auto star : stars)
+				sketch.line(half_size, star);
+			sketch.line_width(1.5).outline(rgba_vector(0,0,0,1));
+		}
+		suite.check(again.pixels() == lines, "same pixels on any number of threads");
+	}
+
+	return suite.report();
+}
@@ -0,0 +1,122 @@
+// mountains of starry_night_sky, midpoint displacement in place against inserting
+// the points one by one, and the drawing as one polygon against a line per column,
+// up to 8K wide
+#define SIMPLE_VG_RECORD
+#include <random>
+#include <vector>
+#include <string>
+#include <cmath>
+#include "harness.hpp"
+#include "../common/simple_vg.h"
+#include "../common/simple_vg.cpp"
+#include "../common/terrain.hpp"
+
+using namespace simple;
+using namespace simple::vg;
+using namespace common;
+
+// what starry_night_sky did, each insert moving everything after it,
+// except for going one past the end every level
+std::vector<float> inserting(float width, float start, float end, float displacement, float roughness, std::mt19937& random)
+{
+	std::vector peaks = {start, end};
+	while(peaks.size() < width + 113)
+	{
+		for(size_t i = 0; i + 1 < peaks.size(); i += 2)
+		{
+			const float variation = std::uniform_real_distribution<float>(-1.f, 1.f)(random) * displacement;
+			const float height = (peaks[i] + peaks[i+1])/2 + variation;
+			peaks.insert(peaks.begin() + i + 1, height);
+		}
+		displacement = displacement * std::pow(2.f, -roughness);
+	}
+	return peaks;
+}
+
+int main(int argc, char* argv[])
+{
+	bench::suite suite("terrain", argc, argv);
+	canvas canvas(canvas::flags::antialias | canvas::flags::stencil_strokes);
+	auto& stats = canvas.recorder().stats;
+
+	for(float width : {1920.f, 7680.f})
+	{
+		const auto name = "/width=" + std::to_string(int(width));
+		const float2 size(width, width * 9 / 16);
+		const float start = 300, end = 300, displacement = 100, roughness = 1;
+
+		std::mt19937 random(1234);
+		std::vector<float> reference;
+		suite.run("inserting" + name, width, [&]()
+		{
+			reference = inserting(width, start, end, displacement, roughness, random);
+			bench::keep(reference);
+		});
+
+		std::vector<float> peaks(midpoint_size(width + 113));
+		std::vector<float> variations(peaks.size() / 2);
+		const auto uniform = [&random](rangef range)
+		{
+			return std::uniform_real_distribution<float>(range.lower(), range.upper())(random);
+		};
+		suite.run("midpoint_displacement" + name, width, [&]()
+		{
+			peaks.front() = start;
+			peaks.back() = end;
+			midpoint_displacement(support::make_range(peaks.data(), peaks.data() + peaks.size()),
+				displacement, std::pow(2.f, -roughness), uniform, variations.data());
+			bench::keep(peaks);
+		});
+
+		// the same random numbers in the same order make the same mountains
+		random.seed(4321);
+		reference = inserting(width, start, end, displacement, roughness, random);
+		random.seed(4321);
+		peaks.front() = start;
+		peaks.back() = end;
+		midpoint_displacement(support::make_range(peaks.data(), peaks.data() + peaks.size()),
+			displacement, std::pow(2.f, -roughness), uniform, variations.data());
+		double error = 0;
+		for(size_t i = 0; i < peaks.size(); ++i)
+			error = std::max<double>(error, std::abs(peaks[i] - reference[i]));
+		suite.check(reference.size() == peaks.size() && error < 1e-3f,
+			"midpoint_displacement" + name + " makes the same mountains as inserting");
+
+		const auto draw_lines = [&](frame& frame)
+		{
+			auto sketch = frame.begin_sketch();
+			for(size_t i = 0; i < width; ++i)
+				sketch.line({float(i), peaks[i]}, {float(i), size.y()});
+			sketch.line_width(2).outline(rgba_vector(0,0,0,1));
+		};
+		const auto draw_polygon = [&](frame& frame)
+		{
+			auto sketch = frame.begin_sketch();
+			sketch.move({0.f, size.y()});
+			for(size_t i = 0; i <= width; ++i)
+				sketch.vertex({float(i), peaks[i]});
+			sketch.vertex(size);
+			sketch.fill(rgba_vector(0,0,0,1));
+		};
+
+		const auto measure = [&](const std::string& kind, auto draw)
+		{
+			suite.run("draw_" + kind + name, width, [&]()
+			{
+				canvas.clear();
+				auto frame = canvas.begin_frame(size);
+				draw(frame);
+			});
+			stats = {};
+			{ auto frame = canvas.begin_frame(size);
+				draw(frame);
+			}
+			suite.metric("draw_calls", stats.draw_calls())
+				.metric("vertices", stats.vertices);
+		};
+		measure("lines", draw_lines);
+		measure("polygon", draw_polygon);
+	}
+
+	return suite.report();
+}
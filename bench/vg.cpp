@@ -0,0 +1,230 @@
+// simple_vg through the recording backend, what it costs to build frames,
+// without the GPU doing any of the drawing
+#define SIMPLE_VG_RECORD
+#include <random>
+#include <vector>
+#include <cmath>
+#include "harness.hpp"
+#include "../common/simple_vg.h"
+#include "../common/simple_vg.cpp"
+#include "../common/terrain.hpp"
+
+using namespace simple;
+using namespace simple::vg;
+
+const float2 size(400,400);
+
+// same sketches as starry_night_sky.cpp draws
+void starry_sky(canvas& canvas, std::mt19937& random)
+{
+	std::uniform_real_distribution<float> unit(0, 1);
+	auto frame = canvas.begin_frame(size);
+
+	frame.begin_sketch()
+		.rectangle({float2::zero(), size})
+		.fill(rgba_vector::white());
+
+	for(float i = 0.f; i < size.y(); ++i)
+	{
+		frame.begin_sketch()
+			.line_width(2)
+			.line({0.f,i},{size.x(),i})
+			.outline(rgba_vector::white());
+	}
+
+	frame.begin_sketch()
+		.ellipse({size/2 - 25, size/2 + 25})
+		.fill(rgba_vector::white());
+
+	for(int i = 0; i < 100; ++i)
+	{
+		const auto star = float2(unit(random), unit(random)) * size;
+		frame.begin_sketch()
+			.rectangle({star, star + float2::one(2)})
+			.fill(rgba_vector::white());
+	}
+
+	// kept from one frame to the next, like the sketch does
+	static std::vector<float> peaks(common::midpoint_size(size.x() + 113));
+	static std::vector<float> variations(peaks.size() / 2);
+	peaks.front() = peaks.back() = 300;
+	common::midpoint_displacement(support::make_range(peaks.data(), peaks.data() + peaks.size()),
+		100, std::pow(2.f, -1.f), [&random](rangef range)
+		{
+			return std::uniform_real_distribution<float>(range.lower(), range.upper())(random);
+		},
+		variations.data());
+
+	{ auto mountains = frame.begin_sketch();
+		mountains.move({0.f, size.y()});
+		for(std::size_t i = 0; i <= size.x(); ++i)
+			mountains.vertex({float(i), peaks[i]});
+		mountains.vertex(size);
+		mountains.fill(rgba_vector::white());
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	bench::suite suite("vg", argc, argv);
+	std::mt19937 random(1234);
+	canvas canvas(canvas::flags::antialias | canvas::flags::stencil_strokes);
+	auto& stats = canvas.recorder().stats;
+
+	const auto per_frame = [&](const char* name, auto&& draw)
+	{
+		stats = {};
+		draw();
+		suite.metric(std::string(name) + "/draw_calls", stats.draw_calls())
+			.metric(std::string(name) + "/resets", stats.resets)
+			.metric(std::string(name) + "/paths", stats.paths)
+			.metric(std::string(name) + "/vertices", stats.vertices);
+		return stats;
+	};
+
+	suite.run("starry_sky", 1, [&]() { starry_sky(canvas, random); });
+	per_frame("frame", [&]() { starry_sky(canvas, random); });
+
+	constexpr int lines = 1000;
+	const auto one_sketch = [&]()
+	{
+		auto frame = canvas.begin_frame(size);
+		auto sketch = frame.begin_sketch();
+		for(int i = 0; i < lines; ++i)
+			sketch.line(float2::zero(), float2(i % 400 + 1, i / 400 * 100));
+		sketch.line_width(1).outline(rgba_vector::white());
+	};
+	suite.run("lines/one_sketch", lines, one_sketch);
+	{
+		const auto s = per_frame("frame", one_sketch);
+		suite.check(s.strokes == 1 && s.resets == 1,
+			"one sketch of lines is one draw call");
+	}
+
+	const auto many_sketches = [&]()
+	{
+		auto frame = canvas.begin_frame(size);
+		for(int i = 0; i < lines; ++i)
+			frame.begin_sketch()
+				.line(float2::zero(), float2(i % 400 + 1, i / 400 * 100))
+				.line_width(1).outline(rgba_vector::white());
+	};
+	suite.run("lines/sketch_each", lines, many_sketches);
+	{
+		const auto s = per_frame("frame", many_sketches);
+		suite.check(s.strokes == lines && s.resets == lines,
+			"a sketch per line is a draw call per line");
+	}
+
+	// the state a sketch sets and puts back, with nothing to tessellate
+	const auto fill_only = [&]()
+	{
+		auto frame = canvas.begin_frame(size);
+		for(int i = 0; i < lines; ++i)
+			frame.begin_sketch().fill(rgba_vector::white());
+	};
+	suite.run("sketches/fill_only", lines, fill_only);
+	{
+		const auto s = per_frame("frame", fill_only);
+		suite.check(s.resets == 0, "a sketch that only sets its paint has nothing to reset");
+	}
+
+	const auto ellipses = [&]()
+	{
+		auto frame = canvas.begin_frame(size);
+		auto sketch = frame.begin_sketch();
+		for(int i = 0; i < lines; ++i)
+		{
+			const auto center = float2(i % 40, i / 40) * 10;
+			sketch.ellipse({center - 3, center + 3});
+		}
+		sketch.fill(rgba_vector::white());
+	};
+	suite.run("ellipses/one_sketch", lines, ellipses);
+	{
+		const auto s = per_frame("frame", ellipses);
+		suite.check(s.fills == 1, "one sketch of ellipses is one draw call");
+	}
+
+	// rings of a circular maze, a part of each in view
+	constexpr unsigned rings = 100;
+	constexpr float span = 1.f/8, anchor = -1.f/4 - span/2;
+	const auto barc = [&]()
+	{
+		auto frame = canvas.begin_frame(size);
+		auto sketch = frame.begin_sketch();
+		for(unsigned i = 0; i < rings; ++i)
+			sketch.arc(size/2, rangef{anchor, anchor + span} * 2*std::acos(-1.f), 10.f + i * 2);
+		sketch.outline(rgba_vector::white());
+	};
+	suite.run("arcs/barc", rings, barc);
+	per_frame("frame", barc);
+
+	const auto polygon = [&]()
+	{
+		auto frame = canvas.begin_frame(size);
+		auto sketch = frame.begin_sketch();
+		for(unsigned i = 0; i < rings; ++i)
+			sketch.arc(size/2, float2::one(10.f + i * 2), span, anchor);
+		sketch.outline(rgba_vector::white());
+	};
+	suite.run("arcs/polygon", rings, polygon);
+	per_frame("frame", polygon);
+
+	const auto concentric = [&]()
+	{
+		auto frame = canvas.begin_frame(size);
+		frame.begin_sketch()
+			.arcs(size/2, 10.f, 2, rings, span, anchor)
+			.outline(rgba_vector::white());
+	};
+	suite.run("arcs/concentric", rings, concentric);
+	{
+		const auto s = per_frame("frame", concentric);
+		suite.check(s.strokes == 1, "concentric arcs are one draw call");
+	}
+
+	// the same arc, bigger on the screen, needs more vertices
+	{
+		const auto arc_vertices = [&](float pixel_ratio, float scale)
+		{
+			stats = {};
+			auto frame = canvas.begin_frame(size, pixel_ratio);
+			frame.begin_sketch()
+				.scale(float2::one(scale))
+				.arc(size/2, float2::one(50), 1)
+				.outline(rgba_vector::white());
+			return stats.vertices;
+		};
+		const auto plain = arc_vertices(1, 1);
+		suite.check(arc_vertices(2, 1) > plain && arc_vertices(1, 2) > plain,
+			"arcs follow the transform and the pixel ratio");
+	}
+
+	// popping puts back the matrix from before the push, without nvgSave
+	{
+		auto frame = canvas.begin_frame(size);
+		auto sketch = frame.begin_sketch();
+		sketch.translate(size/2).push_matrix()
+			.rotate(float2(1,1)).scale(float2::one(3))
+			.pop_matrix();
+		const auto restored = sketch.current_matrix();
+		suite.check(restored.x_axis == float2::i() && restored.y_axis == float2::j()
+			&& restored.origin == size/2, "pop_matrix restores the pushed transform");
+	}
+
+	// as many steps as an arc can take, and not drifting off the circle
+	{
+		float error = 0;
+		unsigned i = 0;
+		arc_directions(1, 0, 4096, [&](float2 direction, bool)
+		{
+			const float angle = 2*std::acos(-1.f) * i++ / 4096;
+			error = std::max(error, (direction - float2(std::cos(angle), std::sin(angle))).length());
+		});
+		suite.metric("arcs/max_step_error", error);
+		suite.check(error < 1e-4f, "arc directions stay on the circle over 4096 steps");
+	}
+
+	return suite.report();
+}
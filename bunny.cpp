@@ -1,54 +1,8 @@
 #include "common/sketchbook.hpp"
+#include "common/region.hpp"
+#include "common/polygon.hpp"
 using namespace common;
 
-struct vertex
-{
-	float2 origin;
-	float2 normal;
-};
-
-struct polygon
-{
-	std::vector<vertex> vertices;
-	explicit operator range2f()
-	{
-		constexpr auto infinity = float2::one(std::numeric_limits<float>::infinity());
-		range2f ret {infinity, -infinity};
-		for(auto&& v : vertices)
-		{
-			ret.lower().min(v.origin);
-			ret.upper().max(v.origin);
-		}
-		return ret;
-	}
-};
-
-
-void update_normals(polygon& p)
-{
-	if(p.vertices.begin() == p.vertices.end())
-		return;
-
-	auto current = p.vertices.begin();
-	auto previous = p.vertices.end()-1;
-
-	do
-	{
-		auto direction = current->origin - previous->origin;
-		previous->normal = rotate(direction, protractor<>::tau(1.f/4));
-		previous = current++;
-	}
-	while(current != p.vertices.end());
-}
-
-bool convex_contains(polygon polygon, float2 point)
-{
-	return support::all_of(polygon.vertices, [&point](auto vertex)
-	{
-		return vertex.normal(point - vertex.origin) > 0;
-	});
-}
-
 void bezier_way(range<vertex*> buffer)
 {
 	auto start = (buffer.begin()+0)->origin;
@@ -86,6 +40,36 @@ bool contain(range<circle*> circles, float2 point)
 	return false;
 }
 
+using exclusion_grid = region_grid<>;
+using cell = exclusion_grid::cell;
+
+auto classify(const circle& circle)
+{
+	return [&circle](range2f box)
+	{
+		auto nearest = circle.center;
+		nearest.max(box.lower());
+		nearest.min(box.upper());
+		const auto radius2 = circle.radius * circle.radius;
+		if(quadrance(nearest - circle.center) >= radius2)
+			return cell::outside;
+
+		for(auto&& corner : corners(box))
+			if(quadrance(corner - circle.center) >= radius2)
+				return cell::boundary;
+		return cell::inside;
+	};
+}
+
+exclusion_grid make_exclusion(float2 aspect, range<circle*> eyes, polygon& nose)
+{
+	exclusion_grid exclusion({float2::zero(), aspect}, int2(aspect * 64));
+	for(auto&& eye : eyes)
+		exclusion.add(range2f(eye), classify(eye));
+	exclusion.add(range2f(nose), classify(nose));
+	return exclusion;
+}
+
 polygon make_nose(float2 aspect)
 {
 	const std::array<vertex, 3> nose_control
@@ -126,7 +110,7 @@ polygon make_nose(float2 aspect)
 	return nose;
 };
 
-void some_fur(frame& frame, rgb_pixel color, range<circle*> eyes, const polygon& nose)
+void some_fur(frame& frame, rgb_pixel color, range<circle*> eyes, const polygon& nose, const exclusion_grid& exclusion)
 {
 	const auto aspect = frame.size/frame.size.x();
 	const auto fur_length = support::average(frame.size.x(),frame.size.y())*12/400;
@@ -137,7 +121,10 @@ void some_fur(frame& frame, rgb_pixel color, range<circle*> eyes, const polygon&
 		float2 root;
 		do
 			root = trand_float2() * aspect;
-		while(contain(eyes, root) || convex_contains(nose, root));
+		while(exclusion.contains(root, [&](auto point)
+		{
+			return contain(eyes, point) || convex_contains(nose, point);
+		}));
 		root *= frame.size.x();
 		auto angle = trand_float();
 
@@ -180,11 +167,12 @@ void start(Program& program)
 			}};
 			nose = make_nose(aspect);
 			nose_bounds = range2f(nose) * frame.size.x();
-			some_fur(frame, 0xbbbbbb_rgb, make_range(eyes), nose);
-			some_fur(frame, 0xcccccc_rgb, make_range(eyes), nose);
-			some_fur(frame, 0xdddddd_rgb, make_range(eyes), nose);
-			some_fur(frame, 0x777777_rgb, make_range(eyes), nose);
-			some_fur(frame, 0x888888_rgb, make_range(eyes), nose);
+			const auto exclusion = make_exclusion(aspect, make_range(eyes), nose);
+			some_fur(frame, 0xbbbbbb_rgb, make_range(eyes), nose, exclusion);
+			some_fur(frame, 0xcccccc_rgb, make_range(eyes), nose, exclusion);
+			some_fur(frame, 0xdddddd_rgb, make_range(eyes), nose, exclusion);
+			some_fur(frame, 0x777777_rgb, make_range(eyes), nose, exclusion);
+			some_fur(frame, 0x888888_rgb, make_range(eyes), nose, exclusion);
 		}
 	);
 
@@ -218,16 +206,20 @@ void start(Program& program)
 		poke.move(poke_value, delta);
 
 		{ auto nose_sketch = frame.begin_sketch();
-			nose_sketch.move(nose.vertices.front().origin * frame.size.x() + poke_value);
+			// the nose stays in the units it was made in, the poke and the size of the
+			// screen are applied by nanovg, the gradient too is in those units
+			nose_sketch.translate(poke_value).scale(float2::one(frame.size.x()));
+			nose_sketch.move(nose.vertices.front().origin);
 			for(size_t i = 1; i < nose.vertices.size(); ++i)
-				nose_sketch.vertex(nose.vertices[i].origin * frame.size.x() + poke_value);
+				nose_sketch.vertex(nose.vertices[i].origin);
 
-			auto size = nose_bounds.upper() - nose_bounds.lower();
+			const auto bounds = range2f(nose);
+			auto size = bounds.upper() - bounds.lower();
 			nose_sketch.fill(paint::radial_gradient(
 				range2f{
-					nose_bounds.lower() + size*0.2f,
-					nose_bounds.lower() + size*0.5f
-				} + poke_value,
+					bounds.lower() + size*0.2f,
+					bounds.lower() + size*0.5f
+				},
 				{0.f, 1.f},
 				{
 					rgba_vector(0xffffff_rgb),
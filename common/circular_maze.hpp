@@ -0,0 +1,671 @@
+#ifndef COMMON_CIRCULAR_MAZE_HPP
+#define COMMON_CIRCULAR_MAZE_HPP
+#include <vector>
+#include <memory>
+#include <random>
+#include <optional>
+#include <algorithm>
+#include <utility>
+#include <cmath>
+#include <cstddef>
+#include "simple/support.hpp"
+#include "simple/graphical.hpp"
+#include "simple_vg.h"
+#include "math.hpp"
+#include "rings.hpp"
+#include "level_cache.hpp"
+#include "ring_graph.hpp"
+
+namespace common
+{
+
+using namespace simple;
+
+// levels of corridors around a center, with walls across them and paths between them,
+// the player is always at the top and the maze turns around them,
+// either a fixed number of levels made up front, or endless, made as the player goes out
+class circular_maze
+{
+	using float2 = vg::float2;
+	using rangef = vg::rangef;
+	using range2f = vg::range2f;
+	using rect = vg::anchored_rect2f;
+
+	// 4097 points, made on first use rather than at compile time
+	using fine_protractor = protractor<12>;
+
+	static constexpr float2 size(range2f x)
+	{
+		return x.upper() - x.lower();
+	}
+
+	[[nodiscard]]
+	static float2 rotate(float2 v, float angle)
+	{
+		return common::rotate(v, fine_protractor::tau(angle));
+	}
+
+	[[nodiscard]]
+	static constexpr float distance(float2 a, float2 b)
+	{
+		return support::root2(quadrance(a-b));
+	}
+
+	static float cord_length(float slice_angle, float radius = 1.f)
+	{
+
+		// very clear - self descriptive
+		// very simple - naive direct implementation
+		// fast?
+		// + distance can be replaced with quadrance
+		return distance(
+			rotate(float2::i(radius), slice_angle),
+			float2::i(radius)
+		);
+
+		// // very obscure - need a picture to understand
+		// // very complicated - need advanced calculus to implement
+		// // slow?
+		// return 2 * radius * sin(slice_angle/2 * tau);
+
+	};
+
+	static constexpr range2f fit(float2 area, float2 unit)
+	{
+		// N dimensional =)
+		auto scale = area/unit;
+		auto min_dimension = support::min_element(scale) - scale.begin();
+		auto fit_area = scale[min_dimension] * unit;
+		auto cenering_mask = float2::one() - float2::unit(min_dimension);
+		return range2f{float2::zero(), fit_area}
+			+ (area - fit_area)/2 * (cenering_mask);
+	};
+
+	int layers = 10;
+	float2 _screen_size;
+	float fov;
+	rangef fov_range;
+	range2f bounds;
+
+	float corridor_radius;
+	float wall_width;
+	float initial_radius;
+
+	float2 center;
+
+	// what is the same for everything on a level, worked out once,
+	// the level is a corridor, with a ring of wall on the inside, where its paths open
+	struct level_geometry
+	{
+		float radius; // middle of the corridor
+		float circumference;
+		float corridor_angle; // how wide the corridor is, in turns
+		float hit_angle; // how close to the player something is in the way, in turns
+		float ring_radius;
+		float wall_angle; // how thick a wall is on the ring, in turns
+		float path_angle; // how wide a path is on the ring, in turns
+	};
+
+	// the sizes everything on a level follows from, small enough to hand over
+	// to the thread that makes the levels of an endless maze
+	struct dimensions
+	{
+		float corridor_radius;
+		float wall_width;
+		float initial_radius;
+
+		// the level is fractional while the player moves between levels
+		float radius(float level) const { return initial_radius + level * corridor_radius; }
+		float corridor_angle(float level) const { return corridor_radius/tau/radius(level); }
+
+		level_geometry of(float level) const
+		{
+			const float radius = this->radius(level);
+			const float ring_radius = radius - corridor_radius/2;
+			return {
+				radius,
+				radius * tau,
+				corridor_angle(level),
+				// closer than half a corridor, in a straight line
+				std::asin(corridor_radius/4/radius) * 2/tau,
+				ring_radius,
+				wall_width/tau/ring_radius,
+				(corridor_radius * 0.8f)/tau/ring_radius
+			};
+		}
+	};
+
+	// starts from level -1, the middle, where the player starts,
+	// up to the last level of a fixed maze, or the last one in view of an endless one
+	std::vector<level_geometry> level_table;
+
+	// angles of each level, sorted, empty when endless
+	rings<> walls;
+	rings<> paths;
+
+	// a level of an endless maze, made from nothing but the seed and its number,
+	// so that it comes out the same whenever and on whichever thread it's made
+	struct ring
+	{
+		std::vector<float> walls;
+		std::vector<float> paths;
+	};
+	std::unique_ptr<level_cache<ring>> stream;
+
+	static constexpr int paths_per_ring = 5;
+
+	dimensions sizes() const { return {corridor_radius, wall_width, initial_radius}; }
+
+	level_geometry geometry(int level) const
+	{
+		if(level + 1 < int(level_table.size()))
+			return level_table[level + 1];
+		return sizes().of(level);
+	}
+
+	// mid move the player is between levels, the table only has whole ones
+	level_geometry geometry(float level) const
+	{
+		if(level == std::floor(level))
+			return geometry(int(level));
+		return sizes().of(level);
+	}
+
+	bool has_level(float level) const
+	{
+		return level >= 0 && (stream || level < layers);
+	}
+
+	// the standard engines are the same everywhere, the standard distributions aren't
+	class ring_random
+	{
+		std::minstd_rand engine;
+
+		public:
+		ring_random(unsigned seed, int level, unsigned kind)
+		{
+			std::seed_seq sequence{seed, unsigned(level), kind};
+			engine.seed(sequence);
+		}
+
+		float operator()(rangef range)
+		{
+			const auto unit = double(engine() - engine.min()) / (double(engine.max() - engine.min()) + 1);
+			return range.lower() + float(unit) * (range.upper() - range.lower());
+		}
+	};
+
+	static std::vector<float> make_paths(const dimensions& sizes, unsigned seed, int level)
+	{
+		ring_random random(seed, level, 0);
+		std::vector<free_arcs<>> free(1);
+		std::vector<float> paths;
+		for(auto&& placed : scatter(sizes, level, free, paths_per_ring, 1.5f, random))
+			paths.push_back(support::wrap(placed.second, 1.f));
+		std::sort(paths.begin(), paths.end());
+		return paths;
+	}
+
+	// same rules as the fixed maze, with about as many walls for the size of the level
+	static ring make_ring(const dimensions& sizes, unsigned seed, int level)
+	{
+		ring made{{}, make_paths(sizes, seed, level)};
+
+		// the paths of the next level are made again here, rather than waiting on it
+		std::vector<free_arcs<>> free(1);
+		for(auto path : made.paths)
+			free[0].take(path, sizes.corridor_angle(level) * 1.5f);
+		for(auto path : make_paths(sizes, seed, level + 1))
+			free[0].take(path, sizes.corridor_angle(level + 1) * 1.5f);
+
+		ring_random random(seed, level, 1);
+		const int count = sizes.radius(level) * tau / sizes.corridor_radius / 3;
+		for(auto&& placed : scatter(sizes, level, free, count, 1.f, random))
+			made.walls.push_back(support::wrap(placed.second, 1.f));
+		std::sort(made.walls.begin(), made.walls.end());
+		return made;
+	}
+
+	// places up to count elements at random, anywhere that's still free on any level,
+	// starting from the first level, each taking out the angles closer than
+	// exclusion corridors around it, stops early when there is no room left,
+	// returns where they went, as level index into free and angle
+	template <typename Random>
+	static std::vector<std::pair<std::size_t, float>>
+	scatter(const dimensions& sizes, int first_level, std::vector<free_arcs<>>& free, int count, float exclusion, Random& random)
+	{
+		// free length of the levels summed up over power of two spans (fenwick tree),
+		// to find the level at an offset into all of them without going over each one
+		std::vector<float> sums(free.size() + 1, 0);
+		const auto add = [&sums](std::size_t level, float length)
+		{
+			for(++level; level < sums.size(); level += level & -level)
+				sums[level] += length;
+		};
+		const auto find = [&sums](float& offset)
+		{
+			std::size_t step = 1;
+			while(step * 2 < sums.size())
+				step *= 2;
+			std::size_t level = 0;
+			for(; step; step >>= 1)
+			{
+				if(level + step < sums.size() && sums[level + step] <= offset)
+				{
+					level += step;
+					offset -= sums[level];
+				}
+			}
+			return level;
+		};
+
+		float total = 0;
+		for(std::size_t level = 0; level < free.size(); ++level)
+		{
+			add(level, free[level].length());
+			total += free[level].length();
+		}
+
+		std::vector<std::pair<std::size_t, float>> placed;
+		placed.reserve(count);
+
+		for(int i = 0; i < count && total > 0; ++i)
+		{
+			// same odds as a random level and a random angle, tried until free
+			float offset = random({0, total});
+			auto level = find(offset);
+			// rounding can land past the end, or on a level that just got full
+			if(level >= free.size() || free[level].empty())
+			{
+				const auto last_free = std::find_if(free.rbegin(), free.rend(),
+					[](auto& arcs) { return !arcs.empty(); });
+				if(last_free == free.rend())
+					break;
+				level = free.rend() - last_free - 1;
+				offset = 0;
+			}
+
+			const auto angle = free[level].at(std::min(offset, free[level].length()));
+			placed.emplace_back(level, angle);
+			const auto length = free[level].length();
+			free[level].take(angle, sizes.corridor_angle(first_level + level) * exclusion);
+			add(level, free[level].length() - length);
+			total += free[level].length() - length;
+		}
+		return placed;
+	}
+
+	using level_elements = rings<>::level_range (circular_maze::*)(int);
+
+	// in endless mode the view follows the player out, keeping them in the middle
+	float view_level() const
+	{
+		return stream ? std::max(0.f, player_level - layers/2) : 0.f;
+	}
+
+	// what part of the maze is on screen
+	struct view_window
+	{
+		float2 center;
+		rangef fov_range_up;
+		int first_level;
+		int last_level;
+	};
+
+	view_window view() const
+	{
+		const float first = view_level();
+		// the screen is as wide as it was, but the rings on it are wider the further out they are
+		const float scale = (2 + layers) / (2 + layers + first);
+		return {
+			center + float2::j(first * corridor_radius),
+			fov_range * scale - 1.f/4,
+			stream ? std::max(int(first) - 1, 0) : 0,
+			stream ? int(first) + layers + 2 : layers
+		};
+	}
+
+	circular_maze(float2 screen_size, int layers) :
+		layers(layers),
+		_screen_size(screen_size),
+		fov(1.f/8),
+		fov_range{-fov/2,+fov/2},
+		bounds{fit(screen_size,{cord_length(fov),1.f})},
+		corridor_radius( size(bounds).y() / (layers+2) ),
+		wall_width(corridor_radius/6),
+		initial_radius(corridor_radius * 2),
+		center{bounds.lower()+(bounds.upper() - bounds.lower()) * float2{0.5f,1.f}},
+		walls(layers),
+		paths(layers)
+	{
+		level_table.reserve(layers + 2);
+		for(int level = -1; level <= layers; ++level)
+			level_table.push_back(sizes().of(level));
+	}
+
+	public:
+	float current_angle = 0;
+	float player_level = -1;
+	auto get_corridor_radius() const {return corridor_radius;}
+	auto get_layers() const {return layers;}
+	const rings<>& get_walls() const {return walls;}
+	const rings<>& get_paths() const {return paths;}
+
+	// random takes a range of floats and returns one within it
+	template <typename Random>
+	circular_maze(float2 screen_size, int layers, Random&& random) :
+		circular_maze(screen_size, layers)
+	{
+		// a path is half a corridor wide, and its edges need a corridor of room on either side
+		std::vector<free_arcs<>> free(layers);
+		paths.assign(scatter(sizes(), 0, free, layers * paths_per_ring, 1.5f, random));
+
+		// a wall needs a corridor of room from other walls, and from the edges of paths on both sides of it
+		free.assign(std::max(layers - 1, 0), {});
+		for(int level = 0; level < int(free.size()); ++level)
+		{
+			for(auto path : paths[level])
+				free[level].take(path, geometry(level).corridor_angle * 1.5f);
+			for(auto path : paths[level + 1])
+				free[level].take(path, geometry(level + 1).corridor_angle * 1.5f);
+		}
+		walls.assign(scatter(sizes(), 0, free, layers * layers, 1.f, random));
+	}
+
+	// levels made from the seed in the background as the player gets close to them,
+	// and forgotten once far enough behind, layers is how many are in view at once,
+	// so there is only ever about as much of it as of a fixed maze of three times that
+	static circular_maze endless(float2 screen_size, int layers, unsigned seed)
+	{
+		circular_maze maze(screen_size, layers);
+		maze.stream = std::make_unique<level_cache<ring>>(3 * (layers + 2),
+			[sizes = maze.sizes(), seed](int level) { return make_ring(sizes, seed, level); });
+		maze.stream->prefetch(0, 2 * layers + 2);
+		return maze;
+	}
+
+	bool is_endless() const { return bool(stream); }
+
+	// angles of a level, sorted, made on the spot if an endless maze doesn't have it yet,
+	// only good until the next draw
+	rings<>::level_range walls_of(int level)
+	{
+		if(!stream)
+			return walls[level];
+		const auto& ring = (*stream)[level];
+		return support::make_range(ring.walls.data(), ring.walls.data() + ring.walls.size());
+	}
+
+	rings<>::level_range paths_of(int level)
+	{
+		if(!stream)
+			return paths[level];
+		const auto& ring = (*stream)[level];
+		return support::make_range(ring.paths.data(), ring.paths.data() + ring.paths.size());
+	}
+
+	// from the first level to the one before last, level -1 being the middle
+	ring_graph graph(int first_level, int last_level)
+	{
+		return ring_graph(first_level, last_level,
+			[this](int level) { return walls_of(level); },
+			[this](int level) { return paths_of(level); });
+	}
+
+	// the way from where the player is to the given level, through the fewest paths,
+	// an endless maze only looks as many levels around as there are in view,
+	// and only at the ones the background thread already made, so that nothing is made on the spot,
+	// nothing if the level is not among them
+	std::optional<std::vector<radial_movement>> route(int level)
+	{
+		const int from = std::lround(player_level);
+		int first_level = -1, last_level = layers;
+		if(stream)
+		{
+			first_level = std::max(from, 0);
+			while(first_level > std::max(std::min(from, level) - layers, 0) && stream->contains(first_level - 1))
+				--first_level;
+			if(first_level == 0)
+				first_level = -1;
+			last_level = std::max(from, 0);
+			while(last_level < std::max(from, level) + layers + 1 && stream->contains(last_level))
+				++last_level;
+		}
+		if(level < std::max(first_level, 0) || level >= last_level || from >= last_level)
+			return std::nullopt;
+		return graph(first_level, last_level).route(from, 3/4.f - current_angle, level);
+	}
+
+	// whether there is a way from the middle out to the last level,
+	// or the last one of the first screen of an endless maze
+	bool solvable()
+	{
+		return layers > 0 && graph(-1, layers).route(-1, 0, layers - 1).has_value();
+	}
+
+	// how many times an endless maze had to make a level on the spot
+	std::size_t misses() const { return stream ? stream->misses : 0; }
+	std::size_t levels_kept() const { return stream ? stream->size() : walls.levels(); }
+
+	const float2& screen_size() { return _screen_size; }
+
+	std::optional<float> hit_test(float angle, float level, level_elements elements_of)
+	{
+		if(!has_level(level))
+			return std::nullopt;
+
+		// the player is at the top, 3/4 of a turn, only the element closest to it can be close enough
+		const auto level_elements = (this->*elements_of)(level);
+		const auto element = closest_angle(level_elements, 3/4.f - angle);
+		if(element == level_elements.end())
+			return std::nullopt;
+
+		if(mod_distance(support::wrap(angle + *element, 1.f), 3/4.f, 1.f) < geometry(level).hit_angle)
+			return *element;
+		return std::nullopt;
+	}
+
+	std::optional<float> wall_hit_test(float angle)
+	{
+		return hit_test(angle, player_level, &circular_maze::walls_of);
+	}
+
+	std::optional<float> path_hit_test(float angle, float level, float direction)
+	{
+		return hit_test(angle, level + (direction+1)/2, &circular_maze::paths_of);
+	}
+
+	void circular_move(float velocity)
+	{
+		const auto level = geometry(player_level);
+		const auto max_angular_velocity = level.corridor_angle*0.8f;
+		float angular_velocity = velocity/level.circumference;
+		if(std::abs(angular_velocity) > max_angular_velocity)
+			angular_velocity = std::copysign(max_angular_velocity, angular_velocity);
+
+		auto new_angle = support::wrap(current_angle + angular_velocity, 1.f);
+		auto hit_wall = wall_hit_test(new_angle);
+		if(!hit_wall)
+		{
+			current_angle = new_angle;
+		}
+		else
+		{
+			const auto offset = std::copysign(level.corridor_angle*0.51f, mod_difference(current_angle + *hit_wall, 3.f/4, 1.f));
+			current_angle = support::wrap(3.f/4 - *hit_wall - offset, 1.f);
+		}
+	}
+
+	void draw(vg::frame& frame)
+	{
+		using namespace graphical::color_literals;
+
+		frame.begin_sketch()
+			.rectangle(rect{ frame.size })
+			.fill(0x1d4151_rgb)
+		;
+
+		const auto [center, fov_range_up, first_level, last_level] = view();
+
+		// what is about to come into view gets made while this is in view,
+		// and what is out of the way gets thrown out
+		if(stream)
+		{
+			stream->update();
+			stream->prefetch(std::max(first_level - layers/2, 0), last_level + layers);
+		}
+
+		frame.begin_sketch()
+			.arcs(center, geometry(first_level).ring_radius, corridor_radius, last_level - first_level,
+				fov_range_up.upper() - fov_range_up.lower(), fov_range_up.lower())
+			.line_width(wall_width).outline(0xfbfbf9_rgb);
+
+		// where things need to be in the maze to show up in the field of view
+		const auto visible_range = fov_range_up + 1.f - current_angle;
+
+		{auto sketch = frame.begin_sketch();
+		for(int level = first_level; level < last_level; ++level)
+		{
+			const auto ring = geometry(level);
+			auto path_arc_range = support::range{-ring.path_angle, ring.path_angle}/2;
+			const auto visible_paths = support::range{
+				visible_range.lower() + path_arc_range.lower(),
+				visible_range.upper() + path_arc_range.upper()};
+			for(auto run : angles_within(paths_of(level), visible_paths))
+			for(auto path : run)
+			{
+				const auto path_angle = support::wrap(
+					path + current_angle,
+				1.f);
+				if(!(fov_range_up + 1.f).intersects(path_arc_range + path_angle))
+					continue;
+
+				sketch.arc(center, float2::one(ring.ring_radius),
+					path_arc_range.upper() - path_arc_range.lower(),
+					path_arc_range.lower() + path_angle);
+			}
+		} sketch.line_width(wall_width + 3).outline(0x1d4151_rgb); }
+
+		// walls are cut to different widths at the edges of the view, so rather than
+		// a line each, they are all quads in one polygon, filled in one go
+		{auto sketch = frame.begin_sketch();
+		for(int level = first_level; level < last_level; ++level)
+		{
+			const auto ring = geometry(level);
+			const auto wall_arc_range = support::range{-ring.wall_angle, ring.wall_angle}/2;
+			const auto visible_walls = support::range{
+				visible_range.lower() + wall_arc_range.lower(),
+				visible_range.upper() + wall_arc_range.upper()};
+			for(auto run : angles_within(walls_of(level), visible_walls))
+			for(auto wall : run)
+			{
+				const auto wall_angle = support::wrap(
+					wall + current_angle,
+				1.f);
+				const auto intersection = (fov_range_up + 1.f).intersection(wall_arc_range + wall_angle);
+				if(!intersection.valid())
+					continue;
+
+				const auto visible_wall_angle = intersection.upper() - intersection.lower();
+				const auto visible_wall_width = wall_width * visible_wall_angle/ring.wall_angle;
+				const auto wall_anchor = intersection.lower() == (fov_range_up + 1.f).lower() ? .5f : -.5f;
+
+				// both ends at the same angle, one lookup
+				const auto wall_rotation = rotor<>(fine_protractor::tau(
+					support::wrap(wall_angle + wall_anchor * (ring.wall_angle - visible_wall_angle), 1.f)
+				));
+
+				const auto inner = float2::i(ring.ring_radius);
+				const auto outer = float2::i(ring.ring_radius + corridor_radius);
+				const auto side = float2::j(visible_wall_width/2);
+				sketch
+					.move(center + wall_rotation(inner - side))
+					.vertex(center + wall_rotation(outer - side))
+					.vertex(center + wall_rotation(outer + side))
+					.vertex(center + wall_rotation(inner + side));
+			}
+		} sketch.fill(0xfbfbf9_rgb); }
+
+		const auto player_diameter =
+			corridor_radius - wall_width -3;
+		const auto player_center =
+			center - float2::j(player_level * corridor_radius + initial_radius);
+		frame.begin_sketch().ellipse(rect{
+			float2::one(player_diameter),
+			player_center,
+			half
+		}).fill(vg::paint::radial_gradient(
+			player_center,
+			{player_diameter/2 * .3f, player_diameter/2},
+			{vg::rgba_vector(0x00feed'ff_rgba), vg::rgba_vector(0x00000000_rgba)}));
+	};
+
+	void diagram(vg::frame& frame)
+	{
+		using namespace graphical::color_literals;
+
+		const auto [center, fov_range_up, first_level, last_level] = view();
+		const auto visible_range = fov_range_up + 1.f - current_angle;
+		auto sketch = frame.begin_sketch();
+		sketch.arcs(center, geometry(first_level).radius, corridor_radius, last_level - first_level,
+			fov_range_up.upper() - fov_range_up.lower(), fov_range_up.lower());
+
+		for(int level = first_level; level < last_level; ++level)
+		{
+			for(auto run : angles_within(walls_of(level), visible_range))
+			for(auto wall : run)
+			{
+				const auto wall_angle = support::wrap(
+					wall + current_angle,
+				1.f);
+				if(!(fov_range_up + 1.f).contains(wall_angle))
+					continue;
+				sketch.ellipse(rect{
+					float2::one(4),
+					center +
+					rotate(
+						float2::i(geometry(level).radius),
+						wall_angle
+					),
+					half
+				});
+			}
+		}
+
+		for(int level = first_level; level < last_level; ++level)
+		{
+			for(auto run : angles_within(paths_of(level), visible_range))
+			for(auto path : run)
+			{
+				const auto path_angle = support::wrap(
+					path + current_angle,
+				1.f);
+				if(!(fov_range_up + 1.f).contains(path_angle))
+					continue;
+
+				const auto path_rotation = rotor<>(fine_protractor::tau(path_angle));
+				sketch.line(
+					center + path_rotation(
+						float2::i(geometry(level).radius)
+					),
+					center + path_rotation(
+						float2::i(geometry(level - 1).radius)
+					)
+				);
+			}
+		}
+
+		sketch.ellipse(rect{
+			float2::one(corridor_radius),
+			center - float2::j(player_level * corridor_radius + initial_radius),
+			half
+		});
+
+		sketch.line_width(1).outline(0x0_rgb);
+	}
+
+};
+
+} // namespace common
+
+#endif /* end of include guard */
@@ -0,0 +1,183 @@
+#ifndef COMMON_INPUT_LOG_HPP
+#define COMMON_INPUT_LOG_HPP
+#include <vector>
+#include <array>
+#include <optional>
+#include <iterator>
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+#include <fstream>
+#include "simple/geom.hpp"
+
+namespace common
+{
+
+using namespace simple;
+
+// input a sketch got, after key repeats are dropped, with when it got it
+struct input_event
+{
+	using float2 = geom::vector<float,2>;
+
+	enum class kind : std::uint8_t
+	{
+		key_down,
+		key_up,
+		mouse_down,
+		mouse_up,
+		mouse_move,
+		quit
+	};
+
+	std::uint64_t time = 0; // microseconds since the first frame
+	kind type = kind::quit;
+	std::int32_t code = 0; // scancode, or mouse button
+	std::int32_t key = 0; // keycode
+	float2 position = float2::zero();
+	float2 motion = float2::zero();
+};
+
+// the file is a magic number, the size of the window and the seed the sketch's random numbers started from,
+// followed by the events, each one the time and the kind, and only what that kind needs after it,
+// 9 to 25 bytes, in the byte order of the machine that wrote it
+struct input_log
+{
+	static constexpr char magic[4] = {'s', 'k', 'i', '1'};
+	using seed_type = std::array<std::uint32_t, 2>;
+
+	std::int32_t width = 0;
+	std::int32_t height = 0;
+	seed_type seed = {};
+	std::vector<input_event> events;
+};
+
+// writes as it goes, flushed every frame, so that there is something to replay even if the sketch is killed
+class input_recorder
+{
+	std::ofstream file;
+
+	template <typename T>
+	void put(const T& value)
+	{
+		char bytes[sizeof(T)];
+		std::memcpy(bytes, &value, sizeof(T));
+		file.write(bytes, sizeof(T));
+	}
+
+	public:
+	input_recorder(const char* filename, std::int32_t width, std::int32_t height, input_log::seed_type seed) :
+		file(filename, std::ios::binary)
+	{
+		file.write(input_log::magic, sizeof(input_log::magic));
+		put(width);
+		put(height);
+		put(seed);
+	}
+
+	explicit operator bool() const { return bool(file); }
+
+	void record(const input_event& event)
+	{
+		using kind = input_event::kind;
+		put(event.time);
+		put(event.type);
+		switch(event.type)
+		{
+			case kind::key_down:
+			case kind::key_up:
+				put(std::uint16_t(event.code));
+				put(event.key);
+			break;
+
+			case kind::mouse_down:
+			case kind::mouse_up:
+				put(std::uint8_t(event.code));
+				put(event.position);
+			break;
+
+			case kind::mouse_move:
+				put(event.position);
+				put(event.motion);
+			break;
+
+			case kind::quit: break;
+		}
+	}
+
+	void flush() { file.flush(); }
+};
+
+// nothing if the file can't be read, or isn't an input log,
+// a log cut short, by the sketch being killed for example, is kept up to the last whole event
+inline std::optional<input_log> read_input_log(const char* filename)
+{
+	std::ifstream file(filename, std::ios::binary);
+	if(!file)
+		return std::nullopt;
+	const std::vector<char> bytes{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+
+	std::size_t offset = 0;
+	const auto get = [&bytes, &offset](auto& value)
+	{
+		if(offset + sizeof(value) > bytes.size())
+			return false;
+		std::memcpy(&value, bytes.data() + offset, sizeof(value));
+		offset += sizeof(value);
+		return true;
+	};
+
+	input_log log;
+	if(bytes.size() < sizeof(input_log::magic)
+		|| std::memcmp(bytes.data(), input_log::magic, sizeof(input_log::magic)) != 0)
+		return std::nullopt;
+	offset = sizeof(input_log::magic);
+	if(!get(log.width) || !get(log.height) || !get(log.seed))
+		return std::nullopt;
+
+	using kind = input_event::kind;
+	while(offset < bytes.size())
+	{
+		input_event event;
+		if(!get(event.time) || !get(event.type))
+			break;
+
+		bool whole = true;
+		switch(event.type)
+		{
+			case kind::key_down:
+			case kind::key_up:
+			{
+				std::uint16_t scancode;
+				whole = get(scancode) && get(event.key);
+				event.code = scancode;
+			}
+			break;
+
+			case kind::mouse_down:
+			case kind::mouse_up:
+			{
+				std::uint8_t button;
+				whole = get(button) && get(event.position);
+				event.code = button;
+			}
+			break;
+
+			case kind::mouse_move:
+				whole = get(event.position) && get(event.motion);
+			break;
+
+			case kind::quit: break;
+
+			default: return std::nullopt;
+		}
+		if(!whole)
+			break;
+		log.events.push_back(event);
+	}
+	return log;
+}
+
+} // namespace common
+
+#endif /* end of include guard */
@@ -0,0 +1,156 @@
+#ifndef COMMON_LEVEL_CACHE_HPP
+#define COMMON_LEVEL_CACHE_HPP
+#include <list>
+#include <vector>
+#include <unordered_map>
+#include <functional>
+#include <utility>
+#include <optional>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstddef>
+
+namespace common
+{
+
+// things made from their level number alone, kept for as long as they were used recently,
+// with a thread making the ones asked for in advance, so that they are there by the time they are needed
+//
+// everything except the making happens on the thread that owns the cache,
+// what the background thread makes waits in a queue until the next update,
+// so references stay valid until then, and nothing is thrown away in between
+template <typename Value>
+class level_cache
+{
+	public:
+	using maker = std::function<Value(int level)>;
+
+	// make needs to be safe to call from another thread
+	level_cache(std::size_t capacity, maker make) :
+		capacity(capacity),
+		make(std::move(make)),
+		worker([this]() { work(); })
+	{}
+
+	level_cache(const level_cache&) = delete;
+
+	~level_cache()
+	{
+		{ std::scoped_lock lock(dam);
+			done = true;
+		}
+		wake.notify_one();
+		worker.join();
+	}
+
+	// made right here if it's not there yet, which is the hitch the rest of this is here to avoid
+	const Value& operator[](int level)
+	{
+		auto found = cached.find(level);
+		if(found == cached.end())
+		{
+			++misses;
+			found = cached.emplace(level, entry{make(level), recent.end()}).first;
+			found->second.recent = recent.insert(recent.begin(), level);
+		}
+		else
+			recent.splice(recent.begin(), recent, found->second.recent);
+		return found->second.value;
+	}
+
+	// asks for levels to be made in the background, from lowest to highest
+	void prefetch(int first, int last)
+	{
+		std::vector<int> levels;
+		for(int level = first; level < last; ++level)
+			if(cached.find(level) == cached.end())
+				levels.push_back(level);
+		{ std::scoped_lock lock(dam);
+			// made already, just not taken in yet
+			levels.erase(std::remove_if(levels.begin(), levels.end(), [this](int level)
+			{
+				return level == making || std::any_of(ready.begin(), ready.end(),
+					[level](auto& made) { return made.first == level; });
+			}), levels.end());
+			wanted = std::move(levels);
+		}
+		wake.notify_one();
+	}
+
+	// takes in what the background thread made, and throws out the least recently used
+	void update()
+	{
+		std::vector<std::pair<int, Value>> made;
+		{ std::scoped_lock lock(dam);
+			made.swap(ready);
+		}
+		for(auto&& [level, value] : made)
+		{
+			if(cached.find(level) != cached.end())
+				continue;
+			// asked for just now, so kept over what hasn't been looked at in a while
+			cached.emplace(level, entry{std::move(value), recent.insert(recent.begin(), level)});
+		}
+
+		while(cached.size() > capacity)
+		{
+			cached.erase(recent.back());
+			recent.pop_back();
+		}
+	}
+
+	// without counting as a use
+	bool contains(int level) const { return cached.find(level) != cached.end(); }
+
+	std::size_t size() const noexcept { return cached.size(); }
+	// how many times a level had to be made on the spot
+	std::size_t misses = 0;
+
+	private:
+	struct entry
+	{
+		Value value;
+		std::list<int>::iterator recent;
+	};
+
+	const std::size_t capacity;
+	const maker make;
+
+	std::unordered_map<int, entry> cached;
+	std::list<int> recent; // most recently used first
+
+	std::mutex dam;
+	std::condition_variable wake;
+	std::vector<int> wanted;
+	std::vector<std::pair<int, Value>> ready;
+	std::optional<int> making;
+	bool done = false;
+	std::thread worker; // last, to start when everything else is ready
+
+	void work()
+	{
+		std::unique_lock lock(dam);
+		while(true)
+		{
+			wake.wait(lock, [this]() { return done || !wanted.empty(); });
+			if(done)
+				return;
+
+			// the latest ask replaces what's left of the previous one
+			const auto level = wanted.front();
+			wanted.erase(wanted.begin());
+			making = level;
+			lock.unlock();
+			auto value = make(level);
+			lock.lock();
+			ready.emplace_back(level, std::move(value));
+			making.reset();
+		}
+	}
+};
+
+} // namespace common
+
+#endif /* end of include guard */
@@ -1,5 +1,9 @@
 #ifndef COMMON_MATH_HPP
 #define COMMON_MATH_HPP
+#include <vector>
+#include <array>
+#include <memory>
+#include <algorithm>
 #include "simple/support.hpp"
 #include "simple/geom.hpp"
 
@@ -79,61 +83,219 @@ Vector normalize(Vector x)
 	return x / support::root2(x.quadrance());
 }
 
-template <size_t Exponent = 3, typename Value = float>
-class protractor
+// same as above, but for many vectors at once, against one surface,
+// anything that only depends on the surface is worked out before the loop,
+// and the loops themselves are simple enough to get vectorized
+// the output may be the same as the input
+
+template <typename Vector, typename Pointer>
+void project(support::range<Pointer> x, Vector surface, Vector* out)
 {
-	public:
-	using vector = geom::vector<Value,2>;
+	const auto scaled_surface = surface / surface.magnitude();
+	const size_t count = x.end() - x.begin();
+	for(size_t i = 0; i < count; ++i)
+		out[i] = scaled_surface * surface(x.begin()[i]);
+}
 
-	using array = std::array<vector, (size_t(1)<<Exponent) + 1>;
+template <typename Vector, typename Pointer>
+void reject(support::range<Pointer> x, Vector surface, Vector* out)
+{
+	const auto scaled_surface = surface / surface.magnitude();
+	const size_t count = x.end() - x.begin();
+	for(size_t i = 0; i < count; ++i)
+		out[i] = x.begin()[i] - scaled_surface * surface(x.begin()[i]);
+}
 
-	static constexpr array circle = []()
-	{
-		using support::halfway;
+template <typename Vector, typename Pointer>
+void reflect(support::range<Pointer> x, Vector surface, Vector* out)
+{
+	const auto scaled_surface = surface * 2 / surface.magnitude();
+	const size_t count = x.end() - x.begin();
+	for(size_t i = 0; i < count; ++i)
+		out[i] = scaled_surface * surface(x.begin()[i]) - x.begin()[i];
+}
 
-		array points{};
+template <typename Vector, typename Pointer>
+void normalize(support::range<Pointer> x, Vector* out)
+{
+	const size_t count = x.end() - x.begin();
+	for(size_t i = 0; i < count; ++i)
+		out[i] = x.begin()[i] / support::root2(x.begin()[i].quadrance());
+}
 
-		points.front() = vector::i();
-		points.back() = -vector::i();
+// ugh! dealing with modulo arithmetic is harder than i thought...
+// could be because i chose (0,1) instead of (-1,1)?
+// there has got to be a better way to do this regardless.
+// maybe just mod/wrap at the last moment and otherwise work in normal arithmetic
+// hint; mod_cmp used in both of below,
+// fix a, consider b and (b +/- mod),
+// calculate diff and abs_diff and chose min by abs_diff
+// return both chosen abs_diff and corresponding diff
+template <typename Value>
+[[nodiscard]] constexpr
+Value mod_distance(Value a, Value b, Value mod)
+{
+	auto minmax = std::minmax(a,b);
+	return std::min( minmax.second - minmax.first, minmax.first + mod - minmax.second);
+}
 
-		auto bisect = [](auto begin, auto end,
-		auto& self)
-		{
-			if(end - begin <= 2)
-				return;
+template <typename Value>
+[[nodiscard]] constexpr
+Value mod_difference(Value a, Value b, Value mod)
+{
+	const auto distance = mod_distance(a,b,mod);
+	const auto difference = b > a ? +distance : -distance;
+	return support::abs(b-a) > distance ? -difference : +difference;
+}
 
-			auto middle = halfway(begin, end);
-			*(middle) = normalize(halfway(*begin, *(end - 1)));
+// does the segment from start to start + direction poke into or pass through the circle,
+// the reasoning is illustrated in line_segment_circle_intersection.cpp
+template <typename Vector, typename Value>
+[[nodiscard]] constexpr
+bool segment_circle_intersects(Vector start, Vector direction, Vector center, Value radius)
+{
+	const auto radius2 = radius * radius;
+	const auto offset = center - start;
+	if(quadrance(offset) < radius2 || quadrance(offset - direction) < radius2)
+		return true;
+
+	const auto length2 = direction.quadrance();
+	if(!(length2 > Value{0}))
+		return false;
+
+	const auto projection_ratio = direction(offset) / length2;
+	return Value{0} <= projection_ratio && projection_ratio <= Value{1} &&
+		quadrance(offset - direction * projection_ratio) < radius2;
+}
 
-			self(begin, middle + 1,
-			self);
-			self(middle, end,
-			self);
-		};
+template <typename Vector, typename Value>
+[[nodiscard]] constexpr
+bool circles_intersect(Vector a, Value a_radius, Vector b, Value b_radius)
+{
+	const auto radius = a_radius + b_radius;
+	return quadrance(a - b) < radius * radius;
+}
 
-		if(Exponent > 0)
-		{
-			auto middle = halfway(points.begin(), points.end());
-			*middle = vector::j();
+enum class interpolation
+{
+	linear,
+	// cubic, using the tangents of the circle at the table points, then normalized,
+	// slower, but good enough for coarse tables
+	hermite
+};
 
-			bisect(points.begin(), middle + 1,
-			bisect);
-			bisect(middle, points.end(),
-			bisect);
-		}
+// approximates half a circle with a regular polygon, by starting with a
+// flat angle and repeatedly bisecting it, level by level,
+// the number of points must be a power of two plus one
+//
+// same code makes the constexpr and the runtime tables
+template <typename Points>
+constexpr void bisect_half_circle(Points& points)
+{
+	using vector = typename Points::value_type;
+	using support::halfway;
+
+	const size_t last = points.size() - 1;
+	assert((last & (last - 1)) == 0);
+
+	points[0] = vector::i();
+	points[last] = -vector::i();
+	if(last < 2)
+		return;
+
+	// can't normalize the halfway of the flat angle, it's zero
+	points[last/2] = vector::j();
+
+	for(size_t step = last/2; step >= 2; step /= 2)
+		for(size_t i = 0; i < last; i += step)
+			points[i + step/2] = normalize(halfway(points[i], points[i + step]));
+}
+
+template <typename Value = float>
+std::vector<geom::vector<Value,2>> make_half_circle(size_t exponent)
+{
+	std::vector<geom::vector<Value,2>> points((size_t(1)<<exponent) + 1);
+	bisect_half_circle(points);
+	return points;
+}
+
+// compile time evaluation gets too slow past this
+constexpr size_t constexpr_protractor_limit = 10;
+
+template <size_t Exponent, typename Value,
+	bool Constexpr = (Exponent <= constexpr_protractor_limit)>
+class protractor_table
+{
+	public:
+	using vector = geom::vector<Value,2>;
+	using array = std::array<vector, (size_t(1)<<Exponent) + 1>;
 
+	static constexpr array circle = []()
+	{
+		array points{};
+		bisect_half_circle(points);
 		return points;
 	}();
 
+	static constexpr const array& table() { return circle; }
+};
+
+// big tables are made on first use
+template <size_t Exponent, typename Value>
+class protractor_table<Exponent, Value, false>
+{
+	public:
+	using vector = geom::vector<Value,2>;
+	using array = std::array<vector, (size_t(1)<<Exponent) + 1>;
+
+	static const array& table()
+	{
+		static const auto points = []()
+		{
+			auto points = std::make_unique<array>();
+			bisect_half_circle(*points);
+			return points;
+		}();
+		return *points;
+	}
+};
 
+template <size_t Exponent = 3, typename Value = float>
+class protractor : public protractor_table<Exponent, Value>
+{
+	public:
+	using base = protractor_table<Exponent, Value>;
+	using typename base::vector;
+	using typename base::array;
+	using base::table;
+
+	static constexpr size_t size = std::tuple_size_v<array>;
+
+	template <interpolation Interpolation = interpolation::linear>
 	static constexpr vector tau(Value factor)
 	{
 		assert(Value{0} <= factor && factor < Value{1});
-		Value index = factor * (protractor::circle.size() - 1);
+		Value index = factor * (size - 1);
 		int whole = index;
 		Value fraction = index - whole;
-		using support::way;
-		return way(circle[whole], circle[whole+1], fraction);
+		return interpolate<Interpolation>(whole, fraction);
+	}
+
+	// many tau(factor)s at once,
+	// all the table lookups are independent here, so can be vectorized as gathers
+	template <interpolation Interpolation = interpolation::linear, typename Pointer>
+	static void tau(support::range<Pointer> factors, vector* directions)
+	{
+		const Value* factor = factors.begin();
+		const size_t count = factors.end() - factors.begin();
+		constexpr Value last = size - 1;
+		for(size_t i = 0; i < count; ++i)
+		{
+			assert(Value{0} <= factor[i] && factor[i] < Value{1});
+			const Value index = factor[i] * last;
+			const int whole = index;
+			directions[i] = interpolate<Interpolation>(whole, index - whole);
+		}
 	}
 
 	static constexpr vector tau()
@@ -141,6 +303,36 @@ class protractor
 		return -vector::i();
 	}
 
+	template <interpolation Interpolation>
+	static constexpr vector interpolate(int whole, Value fraction)
+	{
+		const auto& start = table()[whole];
+		const auto& end = table()[whole+1];
+
+		if constexpr (Interpolation == interpolation::hermite)
+		{
+			// angle between table points, the table covers half a circle
+			constexpr Value step = Value(3.14159265358979323846) / (size - 1);
+			const auto start_tangent = vector(-start.y(), start.x());
+			const auto end_tangent = vector(-end.y(), end.x());
+
+			const Value t = fraction;
+			const Value t2 = t * t;
+			const Value t3 = t2 * t;
+			return normalize(
+				start * (2*t3 - 3*t2 + 1) +
+				start_tangent * (step * (t3 - 2*t2 + t)) +
+				end * (-2*t3 + 3*t2) +
+				end_tangent * (step * (t3 - t2))
+			);
+		}
+		else
+		{
+			using support::way;
+			return way(start, end, fraction);
+		}
+	}
+
 	static constexpr vector small_radian(Value value)
 	{
 		return {support::root2(Value{1} - value*value), value};
@@ -153,7 +345,7 @@ class protractor
 
 	static constexpr vector angle(Value tau_factor)
 	{
-		if(tau_factor < (Value{1}/(circle.size()-1))/16 )
+		if(tau_factor < (Value{1}/(size-1))/16 )
 			return small_radian(tau_factor * common::tau);
 		else
 			return protractor::tau(tau_factor);
@@ -161,6 +353,118 @@ class protractor
 
 };
 
+// a rotation worked out once, to be applied to a lot of vectors,
+// the two reflections of rotate collapse into a 2x2 matrix,
+// and all it takes to store that is where the x axis ends up
+template <typename Value = float>
+class rotor
+{
+	public:
+	using vector = geom::vector<Value,2>;
+
+	constexpr rotor() : axis(vector::i()) {}
+
+	// same half angle as rotate takes, doesn't need to be normalized
+	constexpr explicit rotor(vector half_angle) :
+		axis(vector(
+			half_angle.x() * half_angle.x() - half_angle.y() * half_angle.y(),
+			2 * half_angle.x() * half_angle.y()
+		) / half_angle.quadrance())
+	{}
+
+	template <size_t Exponent = 3, interpolation Interpolation = interpolation::linear>
+	static constexpr rotor tau(Value factor)
+	{
+		return rotor(protractor<Exponent, Value>::template tau<Interpolation>(factor));
+	}
+
+	constexpr vector operator()(vector x) const
+	{
+		return
+		{
+			cos() * x.x() - sin() * x.y(),
+			sin() * x.x() + cos() * x.y()
+		};
+	}
+
+	// many vectors, output may be the same as input
+	template <typename Pointer>
+	void operator()(support::range<Pointer> x, vector* out) const
+	{
+		const auto cos = this->cos();
+		const auto sin = this->sin();
+		const size_t count = x.end() - x.begin();
+		for(size_t i = 0; i < count; ++i)
+		{
+			const auto v = x.begin()[i];
+			out[i] = vector(cos * v.x() - sin * v.y(), sin * v.x() + cos * v.y());
+		}
+	}
+
+	// component-wise storage, x-es in one array and y-s in another
+	void operator()(size_t count, const Value* x, const Value* y, Value* out_x, Value* out_y) const
+	{
+		const auto cos = this->cos();
+		const auto sin = this->sin();
+		for(size_t i = 0; i < count; ++i)
+		{
+			const auto vx = x[i];
+			const auto vy = y[i];
+			out_x[i] = cos * vx - sin * vy;
+			out_y[i] = sin * vx + cos * vy;
+		}
+	}
+
+	// other first, then this,
+	// rounding errors pile up in long chains of these, normalize once in a while
+	constexpr rotor operator*(const rotor& other) const
+	{
+		return from_axis((*this)(other.axis));
+	}
+
+	constexpr rotor& operator*=(const rotor& other)
+	{
+		return *this = *this * other;
+	}
+
+	constexpr rotor inverse() const
+	{
+		return from_axis({cos(), -sin()});
+	}
+
+	rotor normalized() const
+	{
+		return from_axis(normalize(axis));
+	}
+
+	constexpr Value cos() const { return axis.x(); }
+	constexpr Value sin() const { return axis.y(); }
+
+	private:
+	vector axis;
+
+	static constexpr rotor from_axis(vector axis)
+	{
+		rotor result;
+		result.axis = axis;
+		return result;
+	}
+};
+
+template <typename Value, typename Pointer>
+void rotate(support::range<Pointer> x, geom::vector<Value,2> half_angle, geom::vector<Value,2>* out)
+{
+	const rotor<Value> rotation(half_angle);
+	rotation(x, out);
+}
+
+template <typename Value>
+void rotate(size_t count, const Value* x, const Value* y, geom::vector<Value,2> half_angle, Value* out_x, Value* out_y)
+{
+	const rotor<Value> rotation(half_angle);
+	rotation(count, x, y, out_x, out_y);
+}
+
 } // namespace common
 
 #endif /* end of include guard */
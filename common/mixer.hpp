@@ -0,0 +1,54 @@
+#ifndef COMMON_MIXER_HPP
+#define COMMON_MIXER_HPP
+#include <functional>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+
+namespace common
+{
+
+template <typename Duration>
+struct wave
+{
+	std::function<float(float ratio)> function;
+	Duration total;
+	Duration remaining;
+	explicit operator bool() const { return bool(function); }
+};
+
+// adds all the waves that are still playing on top of signed 8 bit mono samples,
+// advancing each by a tick per sample,
+// samples can be any byte sized type, they are reinterpreted through memcpy
+template <typename Waves, typename Duration, typename Samples>
+void mix(Waves& waves, Duration tick, Samples&& samples)
+{
+	std::transform(samples.begin(), samples.end(), samples.begin(), [&waves,&tick](auto v)
+	{
+		std::int8_t typed_v = 0;
+		std::memcpy(&typed_v, &v, 1);
+		float new_v = 0;
+
+		for(auto&& wave : waves)
+		{
+			if(wave && wave.remaining >= tick)
+			{
+				wave.remaining -= tick;
+				if(wave.remaining < tick)
+					wave.remaining = Duration::zero();
+
+				new_v += wave.function(1.f - (wave.remaining.count()/wave.total.count())) * 127.f;
+			}
+		}
+		new_v = new_v + float(typed_v);
+		new_v = std::clamp(new_v, -127.f,127.f);
+
+		typed_v = new_v;
+		std::memcpy(&v, &typed_v, 1);
+		return v;
+	});
+}
+
+} // namespace common
+
+#endif /* end of include guard */
@@ -0,0 +1,227 @@
+#ifndef COMMON_PARALLEL_HPP
+#define COMMON_PARALLEL_HPP
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+
+namespace common
+{
+
+// a fixed set of threads sleeping until there is a parallel_for to help with
+//
+// the index range is cut into chunks, each participant gets an even share of them to
+// go through front to back, and when it runs out it steals half of what's left
+// from the back of someone else's share
+//
+// the calling thread participates as well, and parallel_for returns only after
+// all of the chunks are done, so it's safe to capture things by reference,
+// it's not reentrant though, don't call it from inside of a job
+class thread_pool
+{
+	public:
+
+	static unsigned default_size()
+	{
+#if defined __EMSCRIPTEN__ && !defined __EMSCRIPTEN_PTHREADS__
+		return 1;
+#else
+		return std::max(std::thread::hardware_concurrency(), 1u);
+#endif
+	}
+
+	// size counts the calling thread, so thread_pool(1) does everything inline
+	explicit thread_pool(unsigned size = default_size()) :
+		shares(new share[std::max(size, 1u)])
+	{
+		for(unsigned id = 1; id < size; ++id)
+			workers.emplace_back([this, id]() { work(id); });
+	}
+
+	~thread_pool()
+	{
+		{ std::scoped_lock lock(mutex);
+			stop = true;
+		}
+		wake.notify_all();
+		for(auto&& worker : workers)
+			worker.join();
+	}
+
+	thread_pool(const thread_pool&) = delete;
+	thread_pool& operator=(const thread_pool&) = delete;
+
+	unsigned size() const { return workers.size() + 1; }
+
+	// function(first, last) is called for consecutive sub-ranges of at most grain indices
+	template <typename Function>
+	void parallel_for(size_t begin, size_t end, size_t grain, Function&& function)
+	{
+		if(begin >= end)
+			return;
+		grain = std::max(grain, size_t{1});
+
+		const size_t chunks = (end - begin + grain - 1) / grain;
+		if(chunks == 1 || workers.empty())
+		{
+			for(size_t first = begin; first < end; first += grain)
+				function(first, std::min(first + grain, end));
+			return;
+		}
+
+		std::scoped_lock submission(submit);
+
+		job = {begin, end, grain, &function, [](void* function, size_t first, size_t last)
+		{
+			(*static_cast<Function*>(function))(first, last);
+		}};
+
+		const auto participants = size();
+		for(unsigned id = 0; id < participants; ++id)
+			shares[id].chunks.store(pack(
+				chunks * id / participants,
+				chunks * (id + 1) / participants
+			));
+
+		{ std::scoped_lock lock(mutex);
+			busy = workers.size();
+			++generation;
+		}
+		wake.notify_all();
+
+		participate(0);
+
+		std::unique_lock lock(mutex);
+		done.wait(lock, [this]() { return busy == 0; });
+	}
+
+	// aiming for a few chunks per participant, to leave something to steal
+	template <typename Function>
+	void parallel_for(size_t begin, size_t end, Function&& function)
+	{
+		const size_t grain = (end - begin) / (size() * 8) + 1;
+		parallel_for(begin, end, grain, std::forward<Function>(function));
+	}
+
+	private:
+
+	struct job_t
+	{
+		size_t begin;
+		size_t end;
+		size_t grain;
+		void* function;
+		void (*call)(void*, size_t, size_t);
+	};
+
+	// [front, back) chunk indices in one word, so that the owner popping from the front
+	// and thieves taking from the back can all just compare-exchange it
+	struct alignas(64) share
+	{
+		std::atomic<std::uint64_t> chunks{0};
+	};
+
+	static constexpr std::uint64_t pack(std::uint64_t front, std::uint64_t back)
+	{
+		return front << 32 | back;
+	}
+	static constexpr std::uint32_t front(std::uint64_t chunks) { return chunks >> 32; }
+	static constexpr std::uint32_t back(std::uint64_t chunks) { return chunks & 0xFFFFFFFF; }
+
+	std::vector<std::thread> workers;
+	std::unique_ptr<share[]> shares;
+	job_t job{};
+
+	std::mutex submit;
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::condition_variable done;
+	unsigned generation = 0;
+	unsigned busy = 0;
+	bool stop = false;
+
+	void work(unsigned id)
+	{
+		unsigned seen = 0;
+		while(true)
+		{
+			{ std::unique_lock lock(mutex);
+				wake.wait(lock, [&]() { return stop || generation != seen; });
+				if(stop)
+					return;
+				seen = generation;
+			}
+
+			participate(id);
+
+			{ std::scoped_lock lock(mutex);
+				if(--busy == 0)
+					done.notify_one();
+			}
+		}
+	}
+
+	void run(std::uint32_t chunk)
+	{
+		const size_t first = job.begin + chunk * job.grain;
+		job.call(job.function, first, std::min(first + job.grain, job.end));
+	}
+
+	bool pop(share& own, std::uint32_t& chunk)
+	{
+		auto chunks = own.chunks.load();
+		do
+		{
+			if(front(chunks) >= back(chunks))
+				return false;
+			chunk = front(chunks);
+		}
+		while(!own.chunks.compare_exchange_weak(chunks, pack(chunk + 1, back(chunks))));
+		return true;
+	}
+
+	bool steal(share& victim, share& own)
+	{
+		auto chunks = victim.chunks.load();
+		std::uint32_t half;
+		do
+		{
+			if(front(chunks) >= back(chunks))
+				return false;
+			half = (back(chunks) - front(chunks) + 1) / 2;
+		}
+		while(!victim.chunks.compare_exchange_weak(chunks, pack(front(chunks), back(chunks) - half)));
+
+		// nobody touches an empty share, so a plain store is enough
+		own.chunks.store(pack(back(chunks) - half, back(chunks)));
+		return true;
+	}
+
+	void participate(unsigned id)
+	{
+		const auto participants = size();
+		auto& own = shares[id];
+		std::uint32_t chunk;
+		while(true)
+		{
+			while(pop(own, chunk))
+				run(chunk);
+
+			bool stolen = false;
+			for(unsigned offset = 1; offset < participants && !stolen; ++offset)
+				stolen = steal(shares[(id + offset) % participants], own);
+			if(!stolen)
+				return;
+		}
+	}
+
+};
+
+} // namespace common
+
+#endif /* end of include guard */
@@ -0,0 +1,267 @@
+#ifndef COMMON_PARTICLES_HPP
+#define COMMON_PARTICLES_HPP
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <algorithm>
+#include "simple/support.hpp"
+#include "simple/geom.hpp"
+#include "pool.hpp"
+
+namespace common
+{
+
+using namespace simple;
+
+// a growable array stored in fixed size chunks, growing adds a chunk
+// and never moves or copies what's already there,
+// each chunk is contiguous, for loops to go through a chunk at a time
+template <typename T, size_t ChunkSize = 4096>
+class chunked
+{
+	public:
+	static constexpr size_t chunk_size = ChunkSize;
+
+	size_t size() const { return count; }
+	size_t capacity() const { return chunks.size() * ChunkSize; }
+	bool empty() const { return count == 0; }
+
+	T& operator[](size_t i) { return chunks[i / ChunkSize][i % ChunkSize]; }
+	const T& operator[](size_t i) const { return chunks[i / ChunkSize][i % ChunkSize]; }
+	T& back() { return (*this)[count - 1]; }
+
+	T* chunk(size_t c) { return chunks[c].get(); }
+	const T* chunk(size_t c) const { return chunks[c].get(); }
+
+	void push_back(const T& value)
+	{
+		if(count == capacity())
+			chunks.emplace_back(new T[ChunkSize]);
+		(*this)[count++] = value;
+	}
+
+	void pop_back() { --count; }
+
+	void reserve(size_t size)
+	{
+		while(capacity() < size)
+			chunks.emplace_back(new T[ChunkSize]);
+	}
+
+	private:
+	std::vector<std::unique_ptr<T[]>> chunks;
+	size_t count = 0;
+};
+
+// a vector of 2D vectors stored component-wise,
+// x-es in one array and y-s in another
+template <typename Value = float>
+struct lanes
+{
+	using vector = geom::vector<Value,2>;
+	using lane = chunked<Value>;
+
+	lane x;
+	lane y;
+
+	vector operator[](size_t i) const
+	{
+		return {x[i], y[i]};
+	}
+
+	void set(size_t i, vector value)
+	{
+		x[i] = value.x();
+		y[i] = value.y();
+	}
+
+	void push_back(vector value)
+	{
+		x.push_back(value.x());
+		y.push_back(value.y());
+	}
+
+	void reserve(size_t size)
+	{
+		x.reserve(size);
+		y.reserve(size);
+	}
+
+	// the last one takes its place
+	void erase(size_t i)
+	{
+		x[i] = x.back();
+		x.pop_back();
+		y[i] = y.back();
+		y.pop_back();
+	}
+};
+
+// a bunch of point bodies, with the updates written as plain loops
+// over contiguous arrays, so that the compiler can vectorize them
+//
+// indices change when particles are erased, handles don't
+template <typename Value = float>
+class particles
+{
+	public:
+	using vector = geom::vector<Value,2>;
+	using range = support::range<vector>;
+	using handle = typename pool<size_t>::handle;
+
+	using lane = typename lanes<Value>::lane;
+	static constexpr size_t block_size = lane::chunk_size;
+
+	lanes<Value> position;
+	lanes<Value> velocity;
+	lanes<Value> acceleration;
+
+	size_t size() const { return position.x.size(); }
+	size_t capacity() const { return position.x.capacity(); }
+	bool empty() const { return position.x.empty(); }
+
+	void reserve(size_t size)
+	{
+		position.reserve(size);
+		velocity.reserve(size);
+		acceleration.reserve(size);
+		handles.reserve(size);
+		indices.reserve(size);
+	}
+
+	handle push_back(vector position,
+		vector velocity = vector::zero(),
+		vector acceleration = vector::zero())
+	{
+		// storage grows a block at a time, and nothing already in it moves
+		const auto h = indices.emplace(size());
+		handles.push_back(h);
+		this->position.push_back(position);
+		this->velocity.push_back(velocity);
+		this->acceleration.push_back(acceleration);
+		return h;
+	}
+
+	// the last particle takes the place of the erased one, so indices past it
+	// are shuffled around, erase from highest index to lowest to keep the rest in place
+	void erase(size_t i)
+	{
+		indices.erase(handles[i]);
+		handles[i] = handles.back();
+		handles.pop_back();
+		if(i < handles.size())
+			indices[handles[i]] = i;
+
+		position.erase(i);
+		velocity.erase(i);
+		acceleration.erase(i);
+	}
+
+	bool erase(handle h)
+	{
+		if(!contains(h))
+			return false;
+		erase(index(h));
+		return true;
+	}
+
+	bool contains(handle h) const { return indices.contains(h); }
+	size_t index(handle h) const { return indices[h]; }
+	handle handle_of(size_t i) const { return handles[i]; }
+
+	using index_range = support::range<size_t>;
+
+	// all of the updates below can also be done on a part of the particles,
+	// for example to split the work between threads
+
+	// velocity += acceleration; position += velocity;
+	void integrate(index_range part)
+	{
+		add(velocity.x, acceleration.x, part);
+		add(velocity.y, acceleration.y, part);
+		add(position.x, velocity.x, part);
+		add(position.y, velocity.y, part);
+	}
+	void integrate() { integrate(all()); }
+
+	// velocity -= velocity * factor;
+	void drag(Value factor, index_range part)
+	{
+		scale(velocity.x, Value{1} - factor, part);
+		scale(velocity.y, Value{1} - factor, part);
+	}
+	void drag(Value factor) { drag(factor, all()); }
+
+	// toroidal, anything that leaves from one side comes back from the other
+	void wrap(range bounds, index_range part)
+	{
+		wrap(position.x, bounds.lower().x(), bounds.upper().x(), part);
+		wrap(position.y, bounds.lower().y(), bounds.upper().y(), part);
+	}
+	void wrap(range bounds) { wrap(bounds, all()); }
+
+	private:
+
+	pool<size_t> indices;
+	chunked<handle, block_size> handles;
+
+	index_range all() const { return {0, size()}; }
+
+	// f(chunk, first, last) for each piece of the part that is within one chunk,
+	// first and last counted from the start of that chunk
+	template <typename Function>
+	static void by_chunk(index_range part, Function&& f)
+	{
+		for(size_t first = part.lower(); first < part.upper();)
+		{
+			const size_t chunk = first / block_size;
+			const size_t last = std::min(part.upper(), (chunk + 1) * block_size);
+			f(chunk, first - chunk * block_size, last - chunk * block_size);
+			first = last;
+		}
+	}
+
+	static void add(lane& to, const lane& value, index_range part)
+	{
+		by_chunk(part, [&](size_t chunk, size_t first, size_t last)
+		{
+			Value* out = to.chunk(chunk);
+			const Value* in = value.chunk(chunk);
+			for(size_t i = first; i < last; ++i)
+				out[i] += in[i];
+		});
+	}
+
+	static void scale(lane& values, Value factor, index_range part)
+	{
+		by_chunk(part, [&](size_t chunk, size_t first, size_t last)
+		{
+			Value* out = values.chunk(chunk);
+			for(size_t i = first; i < last; ++i)
+				out[i] *= factor;
+		});
+	}
+
+	static void wrap(lane& values, Value lower, Value upper, index_range part)
+	{
+		// no floor or fmod here, truncating conversion and a comparison
+		// vectorize without any special instruction set
+		const Value size = upper - lower;
+		by_chunk(part, [&](size_t chunk, size_t first, size_t last)
+		{
+			Value* out = values.chunk(chunk);
+			for(size_t i = first; i < last; ++i)
+			{
+				Value offset = out[i] - lower;
+				offset -= size * Value(static_cast<int>(offset / size));
+				offset += size * Value(offset < 0);
+				out[i] = lower + offset;
+			}
+		});
+	}
+
+};
+
+} // namespace common
+
+#endif /* end of include guard */
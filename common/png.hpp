@@ -0,0 +1,104 @@
+#ifndef COMMON_PNG_HPP
+#define COMMON_PNG_HPP
+#include <array>
+#include <algorithm>
+#include <iterator>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <fstream>
+
+namespace common
+{
+
+// writes 8 bit RGBA, top row first, without any compression,
+// deflate allows storing the data as is, so this needs no zlib,
+// the files are big, but it's only for snapshots to look at and diff
+inline bool write_png(const char* filename, int width, int height, const unsigned char* rgba)
+{
+	static const auto crc_table = []()
+	{
+		std::array<std::uint32_t, 256> table{};
+		for(std::uint32_t n = 0; n < 256; ++n)
+		{
+			std::uint32_t c = n;
+			for(int k = 0; k < 8; ++k)
+				c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+			table[n] = c;
+		}
+		return table;
+	}();
+
+	std::vector<unsigned char> file;
+	const auto put32 = [&file](std::uint32_t value)
+	{
+		for(int shift = 24; shift >= 0; shift -= 8)
+			file.push_back((value >> shift) & 0xFF);
+	};
+	const auto chunk = [&](const char* type, const std::vector<unsigned char>& data)
+	{
+		put32(data.size());
+		const auto start = file.size();
+		file.insert(file.end(), type, type + 4);
+		file.insert(file.end(), data.begin(), data.end());
+		std::uint32_t crc = 0xFFFFFFFFu;
+		for(auto i = start; i < file.size(); ++i)
+			crc = crc_table[(crc ^ file[i]) & 0xFF] ^ (crc >> 8);
+		put32(crc ^ 0xFFFFFFFFu);
+	};
+
+	const unsigned char signature[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+	file.insert(file.end(), std::begin(signature), std::end(signature));
+
+	std::vector<unsigned char> header;
+	for(std::uint32_t value : {std::uint32_t(width), std::uint32_t(height)})
+		for(int shift = 24; shift >= 0; shift -= 8)
+			header.push_back((value >> shift) & 0xFF);
+	header.insert(header.end(), {8, 6, 0, 0, 0}); // 8 bit, RGBA, deflate, no filter, no interlace
+	chunk("IHDR", header);
+
+	// each row starts with its filter type, none
+	const std::size_t row = std::size_t(width) * 4;
+	std::vector<unsigned char> raw;
+	raw.reserve((row + 1) * height);
+	for(int y = 0; y < height; ++y)
+	{
+		raw.push_back(0);
+		raw.insert(raw.end(), rgba + y * row, rgba + (y + 1) * row);
+	}
+
+	// zlib stream of stored deflate blocks, 64k at most each
+	std::vector<unsigned char> compressed = {0x78, 0x01};
+	std::size_t offset = 0;
+	do
+	{
+		const std::size_t size = std::min<std::size_t>(raw.size() - offset, 0xFFFF);
+		compressed.push_back(offset + size == raw.size() ? 1 : 0);
+		compressed.push_back(size & 0xFF);
+		compressed.push_back(size >> 8);
+		compressed.push_back(~size & 0xFF);
+		compressed.push_back((~size >> 8) & 0xFF);
+		compressed.insert(compressed.end(), raw.begin() + offset, raw.begin() + offset + size);
+		offset += size;
+	}
+	while(offset < raw.size());
+
+	std::uint32_t a = 1, b = 0;
+	for(auto byte : raw)
+	{
+		a = (a + byte) % 65521;
+		b = (b + a) % 65521;
+	}
+	for(int shift = 24; shift >= 0; shift -= 8)
+		compressed.push_back(((b << 16 | a) >> shift) & 0xFF);
+	chunk("IDAT", compressed);
+	chunk("IEND", {});
+
+	std::ofstream out(filename, std::ios::binary);
+	out.write(reinterpret_cast<const char*>(file.data()), file.size());
+	return bool(out);
+}
+
+} // namespace common
+
+#endif /* end of include guard */
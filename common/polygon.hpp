@@ -0,0 +1,90 @@
+#ifndef COMMON_POLYGON_HPP
+#define COMMON_POLYGON_HPP
+#include <vector>
+#include <limits>
+#include "simple/support.hpp"
+#include "simple/geom.hpp"
+#include "math.hpp"
+#include "region.hpp"
+
+namespace common
+{
+
+using namespace simple;
+
+struct vertex
+{
+	geom::vector<float,2> origin;
+	geom::vector<float,2> normal;
+};
+
+struct polygon
+{
+	std::vector<vertex> vertices;
+	explicit operator support::range<geom::vector<float,2>>() const
+	{
+		constexpr auto infinity = geom::vector<float,2>::one(std::numeric_limits<float>::infinity());
+		support::range<geom::vector<float,2>> ret {infinity, -infinity};
+		for(auto&& v : vertices)
+		{
+			ret.lower().min(v.origin);
+			ret.upper().max(v.origin);
+		}
+		return ret;
+	}
+};
+
+// the normal of the edge to the next vertex is stored with the vertex,
+// convex_contains expects them all to point inwards
+inline void update_normals(polygon& p)
+{
+	if(p.vertices.begin() == p.vertices.end())
+		return;
+
+	auto current = p.vertices.begin();
+	auto previous = p.vertices.end()-1;
+
+	do
+	{
+		auto direction = current->origin - previous->origin;
+		previous->normal = rotate(direction, protractor<>::tau(1.f/4));
+		previous = current++;
+	}
+	while(current != p.vertices.end());
+}
+
+inline bool convex_contains(const polygon& polygon, geom::vector<float,2> point)
+{
+	return support::all_of(polygon.vertices, [&point](auto vertex)
+	{
+		return vertex.normal(point - vertex.origin) > 0;
+	});
+}
+
+// for region_grid::add, how a box lies against a convex polygon, the polygon needs to outlive the result
+inline auto classify(const polygon& polygon)
+{
+	using cell = region_grid<float>::cell;
+	return [&polygon](support::range<geom::vector<float,2>> box)
+	{
+		const auto box_corners = corners(box);
+
+		// separated by one of the edges
+		for(auto&& vertex : polygon.vertices)
+			if(support::all_of(box_corners, [&vertex](auto corner)
+			{
+				return vertex.normal(corner - vertex.origin) <= 0;
+			}))
+				return cell::outside;
+
+		// convex, so all corners inside means the whole box is inside
+		return support::all_of(box_corners, [&polygon](auto corner)
+		{
+			return convex_contains(polygon, corner);
+		}) ? cell::inside : cell::boundary;
+	};
+}
+
+} // namespace common
+
+#endif /* end of include guard */
@@ -0,0 +1,150 @@
+#ifndef COMMON_POOL_HPP
+#define COMMON_POOL_HPP
+#include <vector>
+#include <memory>
+#include <optional>
+#include <cstdint>
+#include <cstddef>
+#include <cassert>
+
+namespace common
+{
+
+// objects that never move once created, storage grows a whole chunk at a time,
+// and nothing is ever freed until the pool itself goes away,
+// erased slots are reused for new objects
+//
+// handles remember the generation of the slot they refer to,
+// so a handle to an erased object doesn't accidentally
+// refer to whatever took its place
+template <typename T, size_t ChunkSize = 4096>
+class pool
+{
+	public:
+
+	struct handle
+	{
+		std::uint32_t index;
+		std::uint32_t generation; // odd while alive
+
+		bool operator==(const handle& other) const
+		{
+			return index == other.index && generation == other.generation;
+		}
+		bool operator!=(const handle& other) const { return !(*this == other); }
+	};
+
+	pool() = default;
+	pool(const pool&) = delete;
+	pool& operator=(const pool&) = delete;
+	pool(pool&&) = default;
+	pool& operator=(pool&&) = default;
+
+	template <typename... Args>
+	handle emplace(Args&&... args)
+	{
+		std::uint32_t index;
+		if(!vacant.empty())
+		{
+			index = vacant.back();
+			vacant.pop_back();
+		}
+		else
+		{
+			if(used == capacity())
+				grow();
+			index = used++;
+		}
+
+		auto& slot = at(index);
+		slot.value.emplace(std::forward<Args>(args)...);
+		++slot.generation;
+		++count;
+		return {index, slot.generation};
+	}
+
+	bool erase(handle h)
+	{
+		if(!contains(h))
+			return false;
+
+		auto& slot = at(h.index);
+		slot.value.reset();
+		++slot.generation;
+		vacant.push_back(h.index);
+		--count;
+		return true;
+	}
+
+	bool contains(handle h) const
+	{
+		return h.index < used && at(h.index).generation == h.generation;
+	}
+
+	T* get(handle h)
+	{
+		return contains(h) ? &*at(h.index).value : nullptr;
+	}
+
+	const T* get(handle h) const
+	{
+		return contains(h) ? &*at(h.index).value : nullptr;
+	}
+
+	T& operator[](handle h)
+	{
+		assert(contains(h));
+		return *at(h.index).value;
+	}
+
+	const T& operator[](handle h) const
+	{
+		assert(contains(h));
+		return *at(h.index).value;
+	}
+
+	size_t size() const { return count; }
+	size_t capacity() const { return chunks.size() * ChunkSize; }
+	bool empty() const { return count == 0; }
+
+	void reserve(size_t size)
+	{
+		while(capacity() < size)
+			grow();
+	}
+
+	private:
+
+	struct slot
+	{
+		std::optional<T> value;
+		std::uint32_t generation = 0;
+	};
+
+	std::vector<std::unique_ptr<slot[]>> chunks;
+	std::vector<std::uint32_t> vacant;
+	std::uint32_t used = 0;
+	size_t count = 0;
+
+	void grow()
+	{
+		chunks.emplace_back(new slot[ChunkSize]);
+		// so that erase never allocates
+		vacant.reserve(capacity());
+	}
+
+	slot& at(std::uint32_t index)
+	{
+		return chunks[index / ChunkSize][index % ChunkSize];
+	}
+
+	const slot& at(std::uint32_t index) const
+	{
+		return chunks[index / ChunkSize][index % ChunkSize];
+	}
+
+};
+
+} // namespace common
+
+#endif /* end of include guard */
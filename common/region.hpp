@@ -0,0 +1,134 @@
+#ifndef COMMON_REGION_HPP
+#define COMMON_REGION_HPP
+#include <vector>
+#include <array>
+#include <limits>
+#include <algorithm>
+#include "simple/support.hpp"
+#include "simple/geom.hpp"
+
+namespace common
+{
+
+using namespace simple;
+
+template <typename Vector>
+[[nodiscard]] constexpr
+std::array<Vector,4> corners(const support::range<Vector>& box)
+{
+	return
+	{{
+		box.lower(),
+		Vector(box.upper().x(), box.lower().y()),
+		box.upper(),
+		Vector(box.lower().x(), box.upper().y())
+	}};
+}
+
+// a coarse grid over some bounds, that remembers for each cell whether it's
+// completely inside, completely outside or on the boundary of a union of shapes,
+// so that most point queries are a bounds check and a lookup,
+// and only the ones landing on a boundary cell need the exact test
+template <typename Value = float>
+class region_grid
+{
+	public:
+	using vector = geom::vector<Value,2>;
+	using index = geom::vector<int,2>;
+	using range = support::range<vector>;
+
+	enum class cell : unsigned char
+	{
+		outside,
+		boundary,
+		inside
+	};
+
+	region_grid(range bounds, index resolution) :
+		bounds(bounds),
+		coverage{vector::one(infinity), -vector::one(infinity)},
+		resolution(resolution),
+		cell_size((bounds.upper() - bounds.lower()) / vector(resolution)),
+		cells(resolution.x() * resolution.y(), cell::outside)
+	{}
+
+	// classify(range) -> cell, for each grid cell overlapping the shape bounds,
+	// must only say inside or outside when sure, boundary otherwise
+	template <typename Classify>
+	region_grid& add(range shape_bounds, Classify&& classify)
+	{
+		coverage.lower().min(shape_bounds.lower());
+		coverage.upper().max(shape_bounds.upper());
+
+		const auto first = clamp(cell_of(shape_bounds.lower()));
+		const auto last = clamp(cell_of(shape_bounds.upper()));
+		for(int y = first.y(); y <= last.y(); ++y)
+			for(int x = first.x(); x <= last.x(); ++x)
+			{
+				auto& current = cells[y * resolution.x() + x];
+				if(current == cell::inside)
+					continue;
+				const auto lower = bounds.lower() + vector(index(x,y)) * cell_size;
+				current = std::max(current, classify(range{lower, lower + cell_size}));
+			}
+
+		return *this;
+	}
+
+	// exact(vector) -> bool, the precise test for the union of the shapes
+	template <typename Exact>
+	bool contains(vector point, Exact&& exact) const
+	{
+		if(!within(coverage, point))
+			return false;
+
+		if(!within(bounds, point))
+			return exact(point);
+
+		switch(at(point))
+		{
+			case cell::outside: return false;
+			case cell::inside: return true;
+			default: return exact(point);
+		}
+	}
+
+	cell at(vector point) const
+	{
+		const auto i = clamp(cell_of(point));
+		return cells[i.y() * resolution.x() + i.x()];
+	}
+
+	private:
+	static constexpr Value infinity = std::numeric_limits<Value>::infinity();
+
+	range bounds;
+	range coverage;
+	index resolution;
+	vector cell_size;
+	std::vector<cell> cells;
+
+	static bool within(const range& box, vector point)
+	{
+		return
+			box.lower().x() <= point.x() && point.x() < box.upper().x() &&
+			box.lower().y() <= point.y() && point.y() < box.upper().y();
+	}
+
+	index cell_of(vector point) const
+	{
+		return index((point - bounds.lower()) / cell_size);
+	}
+
+	index clamp(index i) const
+	{
+		i.max(index::zero());
+		i.min(resolution - index::one());
+		return i;
+	}
+
+};
+
+} // namespace common
+
+#endif /* end of include guard */
@@ -0,0 +1,196 @@
+#ifndef COMMON_RING_GRAPH_HPP
+#define COMMON_RING_GRAPH_HPP
+#include <vector>
+#include <optional>
+#include <algorithm>
+#include <utility>
+#include <cmath>
+#include <cstddef>
+#include "simple/support.hpp"
+
+namespace common
+{
+
+using namespace simple;
+
+// a move of the player to a level, through the path at the given angle in the maze,
+// which is turned to the top first, where the player is,
+// or just the turn, when the level is the one the player is on
+struct radial_movement
+{
+	float path = 0;
+	float level = 0;
+};
+
+// a circular maze as a graph, the stretches of corridor between the walls of a level are the nodes,
+// and the paths between levels are the edges, all in a few flat arrays,
+// so that a graph of thousands of levels is still a handful of allocations
+//
+// level -1 is the middle, a single node with no walls, the other levels have a node per wall,
+// each going from its wall to the next one around, or a single node if there are none
+class ring_graph
+{
+	public:
+	// from the first level to the one before last, walls_of and paths_of take a level
+	// and return its angles, sorted, paths of a level lead to the level below
+	template <typename Walls, typename Paths>
+	ring_graph(int first_level, int last_level, Walls&& walls_of, Paths&& paths_of) :
+		first_level(first_level),
+		node_offsets{0}
+	{
+		wall_offsets.reserve(last_level - first_level + 1);
+		node_offsets.reserve(last_level - first_level + 1);
+		wall_offsets.push_back(0);
+		for(int level = first_level; level < last_level; ++level)
+		{
+			if(level >= 0)
+				for(auto wall : walls_of(level))
+					walls.push_back(wall);
+			wall_offsets.push_back(walls.size());
+			const auto level_walls = wall_offsets.back() - wall_offsets[wall_offsets.size() - 2];
+			node_offsets.push_back(node_offsets.back() + std::max<std::size_t>(level_walls, 1));
+		}
+
+		// each path both ways, counted first, to lay them out by node in one array
+		std::vector<std::pair<int, int>> ends;
+		for(int level = first_level + 1; level < last_level; ++level)
+			for(auto path : paths_of(level))
+				ends.emplace_back(node_at(level - 1, path), node_at(level, path));
+
+		edge_offsets.assign(nodes() + 1, 0);
+		for(auto [inner, outer] : ends)
+		{
+			++edge_offsets[inner + 1];
+			++edge_offsets[outer + 1];
+		}
+		for(std::size_t node = 1; node < edge_offsets.size(); ++node)
+			edge_offsets[node] += edge_offsets[node - 1];
+
+		edges.resize(edge_offsets.back());
+		auto next = edge_offsets;
+		auto path = ends.begin();
+		for(int level = first_level + 1; level < last_level; ++level)
+			for(auto angle : paths_of(level))
+			{
+				const auto [inner, outer] = *path++;
+				edges[next[inner]++] = {outer, angle};
+				edges[next[outer]++] = {inner, angle};
+			}
+	}
+
+	int nodes() const noexcept { return node_offsets.back(); }
+	int levels() const noexcept { return node_offsets.size() - 1; }
+
+	// the stretch of corridor the angle is in, the level needs to be in the graph
+	int node_at(int level, float angle) const
+	{
+		const auto level_walls = walls_of(level);
+		if(level_walls.lower() == level_walls.upper())
+			return node_offsets[level - first_level];
+
+		// the last stretch goes across a whole turn, from the last wall to the first
+		const auto after = std::upper_bound(level_walls.lower(), level_walls.upper(),
+			support::wrap(angle, 1.f));
+		const auto wall = after == level_walls.lower() ? level_walls.upper() - 1 : after - 1;
+		return node_offsets[level - first_level] + (wall - level_walls.lower());
+	}
+
+	int level_of(int node) const
+	{
+		return first_level - 1 + (std::upper_bound(node_offsets.begin(), node_offsets.end(), node) - node_offsets.begin());
+	}
+
+	// through the fewest paths, from an angle on a level to anywhere on the target level,
+	// the turns in between are kept to less than half a turn each, so that taking
+	// the shorter way around to the next path never goes through a wall,
+	// nothing if there is no way there
+	std::optional<std::vector<radial_movement>> route(int from_level, float from_angle, int to_level) const
+	{
+		const auto from = node_at(from_level, from_angle);
+
+		// breadth first, each node remembers the edge it was first reached by
+		std::vector<int> reached_by(nodes(), -1);
+		std::vector<int> queue{from};
+		reached_by[from] = edges.size();
+		std::optional<int> to;
+		for(std::size_t next = 0; next < queue.size(); ++next)
+		{
+			const auto node = queue[next];
+			if(level_of(node) == to_level)
+			{
+				to = node;
+				break;
+			}
+			for(auto edge = edge_offsets[node]; edge != edge_offsets[node + 1]; ++edge)
+			{
+				if(reached_by[edges[edge].to] != -1)
+					continue;
+				reached_by[edges[edge].to] = edge;
+				queue.push_back(edges[edge].to);
+			}
+		}
+		if(!to)
+			return std::nullopt;
+
+		std::vector<int> way;
+		for(auto node = *to; node != from; node = source_of(reached_by[node]))
+			way.push_back(reached_by[node]);
+
+		std::vector<radial_movement> movements;
+		int level = from_level;
+		float angle = from_angle;
+		for(auto edge = way.rbegin(); edge != way.rend(); ++edge)
+		{
+			const auto path = edges[*edge].angle;
+			turn(movements, level, angle, path);
+			level = level_of(edges[*edge].to);
+			angle = path;
+			movements.push_back({path, float(level)});
+		}
+		return movements;
+	}
+
+	private:
+	struct edge
+	{
+		int to;
+		float angle;
+	};
+
+	int first_level;
+	std::vector<float> walls;
+	std::vector<std::size_t> wall_offsets;
+	std::vector<int> node_offsets;
+	std::vector<std::size_t> edge_offsets;
+	std::vector<edge> edges;
+
+	support::range<const float*> walls_of(int level) const
+	{
+		const auto index = level - first_level;
+		return support::make_range(walls.data() + wall_offsets[index], walls.data() + wall_offsets[index + 1]);
+	}
+
+	// edges are laid out by the node they go from
+	int source_of(int edge) const
+	{
+		return std::upper_bound(edge_offsets.begin(), edge_offsets.end(), std::size_t(edge)) - edge_offsets.begin() - 1;
+	}
+
+	// along a stretch of corridor, the way that doesn't go through its walls,
+	// split in two if that is the longer way around
+	void turn(std::vector<radial_movement>& movements, int level, float from, float to) const
+	{
+		const auto level_walls = walls_of(level);
+		if(level_walls.lower() == level_walls.upper())
+			return;
+
+		const auto start = *(level_walls.lower() + (node_at(level, from) - node_offsets[level - first_level]));
+		const auto distance = support::wrap(to - start, 1.f) - support::wrap(from - start, 1.f);
+		if(std::abs(distance) >= 1.f/2)
+			movements.push_back({support::wrap(from + distance/2, 1.f), float(level)});
+	}
+};
+
+} // namespace common
+
+#endif /* end of include guard */
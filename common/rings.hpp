@@ -0,0 +1,216 @@
+#ifndef COMMON_RINGS_HPP
+#define COMMON_RINGS_HPP
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <utility>
+#include <cstddef>
+#include "simple/support.hpp"
+#include "math.hpp"
+
+namespace common
+{
+
+using namespace simple;
+
+// angles in turns, [0,1), kept sorted, so that things on a circle
+// can be found by binary search, with the ends of the array
+// being neighbours around the circle
+
+// the closest element going either way around, end if there are none
+template <typename Iterator, typename Value>
+[[nodiscard]] constexpr
+Iterator closest_angle(Iterator begin, Iterator end, Value angle)
+{
+	if(begin == end)
+		return end;
+
+	angle = support::wrap(angle, Value{1});
+	const auto after = std::lower_bound(begin, end, angle);
+	const auto next = after == end ? begin : after;
+	const auto previous = after == begin ? end - 1 : after - 1;
+	return mod_distance(*previous, angle, Value{1}) <= mod_distance(*next, angle, Value{1})
+		? previous : next;
+}
+
+template <typename Range, typename Value>
+[[nodiscard]] constexpr
+auto closest_angle(Range&& angles, Value angle)
+{
+	return closest_angle(std::begin(angles), std::end(angles), angle);
+}
+
+// the angles within a window of less than a turn, [lower, upper), as two runs,
+// the second one non empty only if the window goes across a whole turn,
+// so that what's looked at is only what's in the window
+template <typename Range, typename Value>
+[[nodiscard]] constexpr
+auto angles_within(Range&& angles, support::range<Value> window)
+{
+	using std::begin;
+	using std::end;
+	using iterator = decltype(begin(angles));
+	using run = support::range<iterator>;
+
+	const auto first = begin(angles);
+	const auto last = end(angles);
+	if(window.upper() - window.lower() >= Value{1})
+		return std::array<run, 2>{run{first, last}, run{last, last}};
+
+	const auto lower = support::wrap(window.lower(), Value{1});
+	const auto upper = lower + (window.upper() - window.lower());
+	const auto from = std::lower_bound(first, last, lower);
+	if(upper <= Value{1})
+		return std::array<run, 2>{run{from, std::lower_bound(from, last, upper)}, run{last, last}};
+	return std::array<run, 2>{run{from, last}, run{first, std::lower_bound(first, from, upper - 1)}};
+}
+
+// the angles of all the levels of a circular maze in one array, level after level,
+// with offsets of where each level starts, so that going over all of them
+// is going over one block of memory, instead of a separate allocation per level
+template <typename Value = float>
+class rings
+{
+	std::vector<Value> angles;
+	std::vector<std::size_t> offsets; // one more than there are levels
+
+	public:
+	using level_range = support::range<const Value*>;
+
+	explicit rings(std::size_t levels = 0) :
+		offsets(levels + 1, 0)
+	{}
+
+	std::size_t levels() const noexcept { return offsets.size() - 1; }
+	std::size_t size() const noexcept { return angles.size(); }
+
+	level_range operator[](std::size_t level) const noexcept
+	{
+		return support::make_range(
+			angles.data() + offsets[level],
+			angles.data() + offsets[level + 1]);
+	}
+
+	level_range all() const noexcept
+	{
+		return support::make_range(angles.data(), angles.data() + angles.size());
+	}
+
+	void reserve(std::size_t total) { angles.reserve(total); }
+
+	// keeps the level sorted
+	void insert(std::size_t level, Value angle)
+	{
+		angle = support::wrap(angle, Value{1});
+		const auto level_begin = angles.begin() + offsets[level];
+		const auto level_end = angles.begin() + offsets[level + 1];
+		angles.insert(std::upper_bound(level_begin, level_end, angle), angle);
+		for(auto offset = offsets.begin() + level + 1; offset != offsets.end(); ++offset)
+			++*offset;
+	}
+
+	// replaces everything with the given level and angle pairs, in any order,
+	// much cheaper than inserting them one by one
+	void assign(const std::vector<std::pair<std::size_t, Value>>& elements)
+	{
+		std::fill(offsets.begin(), offsets.end(), 0);
+		for(auto&& element : elements)
+			++offsets[element.first + 1];
+		for(std::size_t level = 1; level < offsets.size(); ++level)
+			offsets[level] += offsets[level - 1];
+
+		angles.resize(elements.size());
+		auto next = offsets;
+		for(auto&& element : elements)
+			angles[next[element.first]++] = support::wrap(element.second, Value{1});
+		for(std::size_t level = 0; level < levels(); ++level)
+			std::sort(angles.begin() + offsets[level], angles.begin() + offsets[level + 1]);
+	}
+
+	void clear(std::size_t levels)
+	{
+		angles.clear();
+		offsets.assign(levels + 1, 0);
+	}
+};
+
+// what's left of a circle after taking arcs out of it, as sorted disjoint ranges in [0,1),
+// to pick a random free angle directly, instead of trying random angles until one is free
+template <typename Value = float>
+class free_arcs
+{
+	using arc = support::range<Value>;
+	std::vector<arc> arcs;
+	Value free_length;
+
+	void take_within(arc taken)
+	{
+		// first arc that ends after the taken one starts
+		auto first = std::upper_bound(arcs.begin(), arcs.end(), taken.lower(),
+			[](Value angle, const arc& free) { return angle < free.upper(); });
+		auto last = first;
+		while(last != arcs.end() && last->lower() < taken.upper())
+			++last;
+		if(first == last)
+			return;
+
+		for(auto free = first; free != last; ++free)
+			free_length -= std::min(free->upper(), taken.upper()) - std::max(free->lower(), taken.lower());
+
+		// only the ends of the first and the last can remain
+		const arc before{first->lower(), taken.lower()};
+		const arc after{taken.upper(), (last - 1)->upper()};
+		auto remaining = arcs.erase(first, last);
+		if(after.lower() < after.upper())
+			remaining = arcs.insert(remaining, after);
+		if(before.lower() < before.upper())
+			arcs.insert(remaining, before);
+		if(arcs.empty())
+			free_length = 0;
+	}
+
+	public:
+	free_arcs() :
+		arcs{arc{Value{0}, Value{1}}},
+		free_length{1}
+	{}
+
+	Value length() const noexcept { return free_length; }
+	bool empty() const noexcept { return arcs.empty(); }
+
+	// takes out everything closer than radius to the center angle
+	void take(Value center, Value radius)
+	{
+		if(radius >= Value{1}/2)
+		{
+			arcs.clear();
+			free_length = 0;
+			return;
+		}
+
+		center = support::wrap(center, Value{1});
+		const arc taken{center - radius, center + radius};
+		take_within({std::max(taken.lower(), Value{0}), std::min(taken.upper(), Value{1})});
+		if(taken.lower() < 0)
+			take_within({taken.lower() + 1, Value{1}});
+		if(taken.upper() > 1)
+			take_within({Value{0}, taken.upper() - 1});
+	}
+
+	// the angle at the given distance along the free arcs, [0, length())
+	Value at(Value distance) const noexcept
+	{
+		for(auto&& free : arcs)
+		{
+			const auto length = free.upper() - free.lower();
+			if(distance < length)
+				return free.lower() + distance;
+			distance -= length;
+		}
+		return arcs.back().upper();
+	}
+};
+
+} // namespace common
+
+#endif /* end of include guard */
@@ -1,11 +1,92 @@
 #include "simple_vg.h"
 #include "simple/support/enum.hpp"
 #include "simple/support/algorithm.hpp"
+#include "math.hpp"
+#include <vector>
+#include <cmath>
+#include <cassert>
 
 using namespace simple::vg;
 
+#if defined SIMPLE_VG_RECORD
+#include "simple_vg_record.cpp"
+#endif
+#if defined SIMPLE_VG_RASTER
+#include "simple_vg_raster.cpp"
+#endif
+
+namespace
+{
+	template <typename RawFramebuffer>
+	void bind_framebuffer([[maybe_unused]] NVGcontext* context, RawFramebuffer* raw) noexcept
+	{
+#if defined SIMPLE_VG_RECORD
+		record::of(context).bind(raw->image);
+#else
+		nvgluBindFramebuffer(raw);
+#endif
+	}
+
+	void unbind_framebuffer([[maybe_unused]] NVGcontext* context) noexcept
+	{
+#if defined SIMPLE_VG_RECORD
+		record::of(context).bind(0);
+#else
+		nvgluBindFramebuffer(nullptr);
+#endif
+	}
+
+	// same as nanovg's tessellation tolerance, in pixels
+	constexpr float arc_tolerance = 0.25f;
+
+	// the sagitta of a segment, r(1 - cos(a/2)), is about r*a*a/8,
+	// so the angle of a segment within tolerance is sqrt(8*tolerance/r)
+	unsigned arc_segments(float radius, float tau_factor) noexcept
+	{
+		const float full_turn = 2*std::acos(-1.f);
+		const float segment_angle = std::sqrt(8 * arc_tolerance / std::max(radius, arc_tolerance));
+		const float segments = std::ceil(std::abs(tau_factor) * full_turn / segment_angle);
+		return unsigned(std::clamp(segments, 1.f, 4096.f));
+	}
+
+	// wrapped into [0,1), that the protractor expects
+	float turns(float factor) noexcept
+	{
+		const auto wrapped = simple::support::wrap(factor, 1.f);
+		return wrapped < 1.f ? wrapped : 0.f;
+	}
+
+	// directions along an arc, one lookup for where it starts,
+	// one for the step, and then just rotating
+	template <typename Visitor>
+	void arc_directions(float tau_factor, float anchor, unsigned segments, Visitor&& visit) noexcept
+	{
+		using rotor = common::rotor<>;
+		// rounding errors pile up over thousands of steps,
+		// so every so often start over from the table
+		constexpr unsigned reanchor = 64;
+		const auto direction_at = [&](unsigned i)
+		{
+			return rotor::tau<12>(turns(anchor + tau_factor * i / segments))(float2::i());
+		};
+		auto direction = direction_at(0);
+		const auto step = rotor::tau<12>(turns(tau_factor / segments));
+		visit(direction, true);
+		for(unsigned i = 1; i <= segments; ++i)
+		{
+			direction = i % reanchor == 0 ? direction_at(i) : step(direction);
+			visit(direction, false);
+		}
+	}
+} // namespace
+
 canvas::canvas(flags f) noexcept :
-#if defined NANOVG_GL2
+#if defined SIMPLE_VG_RASTER
+	// the rasterizer does its own antialiasing, nanovg's fringes would only get in the way
+	raw(record::create(support::to_integer(f) & ~NVG_ANTIALIAS))
+#elif defined SIMPLE_VG_RECORD
+	raw(record::create(support::to_integer(f)))
+#elif defined NANOVG_GL2
 	raw(nvgCreateGL2(support::to_integer(f)))
 #elif defined NANOVG_GL3
 	raw(nvgCreateGL3(support::to_integer(f)))
@@ -19,7 +100,9 @@ canvas::canvas(flags f) noexcept :
 
 void canvas::deleter::operator()(NVGcontext* context) const noexcept
 {
-#if defined NANOVG_GL2
+#if defined SIMPLE_VG_RECORD
+	record::destroy(context);
+#elif defined NANOVG_GL2
 	nvgDeleteGL2(context);
 #elif defined NANOVG_GL3
 	nvgDeleteGL3(context);
@@ -32,8 +115,12 @@ void canvas::deleter::operator()(NVGcontext* context) const noexcept
 
 canvas& canvas::clear(const rgba_vector& color) noexcept
 {
+#if defined SIMPLE_VG_RECORD
+	recorder().clear(nvgRGBAf(color.r(),color.g(),color.b(),color.a()));
+#else
 	glClearColor(color.r(),color.g(),color.b(),color.a());
 	glClear(GL_COLOR_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+#endif
 	return *this;
 }
 
@@ -52,6 +139,13 @@ frame canvas::begin_frame(framebuffer& fb) const noexcept
 	return frame(raw.get(), fb);
 }
 
+#if defined SIMPLE_VG_RECORD
+record::recorder& canvas::recorder() const noexcept
+{
+	return record::of(raw.get());
+}
+#endif
+
 framebuffer::framebuffer(int2 size, enum flags flags) noexcept :
 	flags(flags),
 	size(size),
@@ -68,6 +162,18 @@ bool framebuffer::create(const canvas& canvas)
 	if(raw)
 		return false;
 
+#if defined SIMPLE_VG_RECORD
+	raw = decltype(raw)(new raw_framebuffer{
+		canvas.raw.get(),
+		// same as nvgluCreateFramebuffer, render targets are stored bottom row first and premultiplied
+		nvgCreateImageRGBA(
+			canvas.raw.get(),
+			size.x(), size.y(),
+			support::to_integer(flags) | NVG_IMAGE_FLIPY | NVG_IMAGE_PREMULTIPLIED,
+			nullptr
+		)
+	});
+#else
 	raw = decltype(raw)(
 		nvgluCreateFramebuffer(
 			canvas.raw.get(),
@@ -75,6 +181,7 @@ bool framebuffer::create(const canvas& canvas)
 			support::to_integer(flags)
 		)
 	);
+#endif
 	assert(raw && "nanovg framebuffer must not be null");
 	return true;
 }
@@ -94,9 +201,46 @@ simple::vg::paint framebuffer::paint(float opacity, float angle) const
 	return paint({int2::zero(), size}, opacity, angle);
 }
 
-void framebuffer::deleter::operator()(NVGLUframebuffer* raw) const noexcept
+void framebuffer::deleter::operator()(raw_framebuffer* raw) const noexcept
 {
+#if defined SIMPLE_VG_RECORD
+	nvgDeleteImage(raw->context, raw->image);
+	delete raw;
+#else
 	nvgluDeleteFramebuffer(raw);
+#endif
+}
+
+matrix matrix::translation(float2 offset) noexcept
+{
+	return {float2::i(), float2::j(), offset};
+}
+
+matrix matrix::rotation(float2 half_angle) noexcept
+{
+	// double angle, divided by quadrance in case it's not quite unit
+	const auto& h = half_angle;
+	const auto axis = float2(h.x()*h.x() - h.y()*h.y(), 2*h.x()*h.y()) / h.quadrance();
+	return {axis, float2(-axis.y(), axis.x())};
+}
+
+matrix matrix::scaling(float2 factor) noexcept
+{
+	return {float2::i() * factor.x(), float2::j() * factor.y()};
+}
+
+float2 matrix::operator()(float2 v) const noexcept
+{
+	return x_axis * v.x() + y_axis * v.y() + origin;
+}
+
+matrix matrix::operator*(const matrix& other) const noexcept
+{
+	return {
+		x_axis * other.x_axis.x() + y_axis * other.x_axis.y(),
+		x_axis * other.y_axis.x() + y_axis * other.y_axis.y(),
+		(*this)(other.origin)
+	};
 }
 
 paint::paint(NVGpaint raw) noexcept : raw(raw) {}
@@ -137,13 +281,17 @@ frame::frame(NVGcontext* context, const framebuffer& fb) noexcept :
 	buffer(&fb),
 	context(context)
 {
-	nvgluBindFramebuffer(buffer->raw.get());
+	bind_framebuffer(context, buffer->raw.get());
+#if defined SIMPLE_VG_RECORD
+	record::of(context).clear(nvgRGBAf(0,0,0,0));
+#else
 	glClearColor(0,0,0,0);
 	glClear(GL_COLOR_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 	glViewport(
 		0,0,
 		buffer->size.x(), buffer->size.y()
 	);
+#endif
 	nvgBeginFrame(context, size.x(), size.y(), pixelRatio);
 }
 
@@ -158,34 +306,62 @@ frame::frame(frame&& other) noexcept :
 
 frame::~frame() noexcept
 {
-	if(context)
-		nvgEndFrame(context);
+	if(!context)
+		return;
+	nvgEndFrame(context);
 	if(buffer)
-		nvgluBindFramebuffer(nullptr);
+		unbind_framebuffer(context);
 }
 
 sketch frame::begin_sketch() noexcept
 {
-	return sketch(context);
+	return sketch(context, pixelRatio);
 }
 
-sketch::sketch(NVGcontext* context) noexcept :
-	context(context)
+sketch::sketch(NVGcontext* context, float pixel_ratio) noexcept :
+	context(context),
+	pixel_ratio(pixel_ratio)
 {
-	nvgSave(context);
 	nvgBeginPath(context);
 }
 
 sketch::sketch(sketch&& other) noexcept
 {
 	context = other.context;
+	pixel_ratio = other.pixel_ratio;
+	touched = other.touched;
+	matrix_stack = other.matrix_stack;
+	matrix_depth = other.matrix_depth;
 	other.context = nullptr;
 }
 
 sketch::~sketch() noexcept
 {
 	if(context)
-		nvgRestore(context);
+		reset();
+}
+
+// back to what nvgBeginFrame starts with, paints are left as they are,
+// fill() and outline() put the default back themselves when the sketch didn't set one,
+// so most sketches, that set their own paint and nothing else, don't reset anything
+void sketch::reset() noexcept
+{
+	if((touched & ~(fill_paint | stroke_paint)) == 0)
+		return;
+#if defined SIMPLE_VG_RECORD
+	++record::of(context).stats.resets;
+#endif
+	if(touched & stroke_width)
+		nvgStrokeWidth(context, 1);
+	if(touched & stroke_miter)
+		nvgMiterLimit(context, 10);
+	if(touched & stroke_cap)
+		nvgLineCap(context, NVG_BUTT);
+	if(touched & stroke_join)
+		nvgLineJoin(context, NVG_MITER);
+	if(touched & transformation)
+		nvgResetTransform(context);
+	touched = 0;
 }
 
 void ellipse(NVGcontext* context, const float2& center, const float2& radius) noexcept
@@ -239,15 +415,120 @@ sketch& sketch::arc(float2 center, rangef angle, float radius) noexcept
 	return *this;
 }
 
+sketch& sketch::arc(float2 center, float2 radius, float tau_factor, float anchor) noexcept
+{
+	const auto segments = arc_segments(std::max(radius.x(), radius.y()) * device_scale(), tau_factor);
+	arc_directions(tau_factor, anchor, segments, [&](float2 direction, bool first)
+	{
+		const auto point = center + direction * radius;
+		if(first)
+			move(point);
+		else
+			vertex(point);
+	});
+	return *this;
+}
+
+sketch& sketch::arcs(float2 center, float radius, float spacing, unsigned count,
+	float tau_factor, float anchor) noexcept
+{
+	if(count == 0)
+		return *this;
+
+	// the largest one decides how many segments
+	thread_local std::vector<float2> directions;
+	directions.clear();
+	const auto outer = radius + spacing * (count - 1);
+	arc_directions(tau_factor, anchor, arc_segments(std::max(radius, outer) * device_scale(), tau_factor),
+		[](float2 direction, bool) { directions.push_back(direction); });
+
+	for(unsigned i = 0; i < count; ++i, radius += spacing)
+	{
+		move(center + directions.front() * radius);
+		for(auto direction = directions.begin() + 1; direction != directions.end(); ++direction)
+			vertex(center + *direction * radius);
+	}
+	return *this;
+}
+
+float sketch::device_scale() const noexcept
+{
+	// the largest singular value of the linear part, how much the transform stretches anything at most
+	const auto m = current_matrix();
+	const float t[4] = {m.x_axis.x(), m.x_axis.y(), m.y_axis.x(), m.y_axis.y()};
+	const float sum = t[0]*t[0] + t[1]*t[1] + t[2]*t[2] + t[3]*t[3];
+	const float determinant = t[0]*t[3] - t[1]*t[2];
+	const float difference = std::sqrt(std::max(sum*sum - 4*determinant*determinant, 0.f));
+	return std::sqrt((sum + difference)/2) * pixel_ratio;
+}
+
+sketch& sketch::translate(float2 offset) noexcept
+{
+	nvgTranslate(context, offset.x(), offset.y());
+	touched |= transformation;
+	return *this;
+}
+
+sketch& sketch::rotate(float2 half_angle) noexcept
+{
+	return transform(matrix::rotation(half_angle));
+}
+
+sketch& sketch::scale(float2 factor) noexcept
+{
+	nvgScale(context, factor.x(), factor.y());
+	touched |= transformation;
+	return *this;
+}
+
+sketch& sketch::transform(const matrix& m) noexcept
+{
+	nvgTransform(context,
+		m.x_axis.x(), m.x_axis.y(),
+		m.y_axis.x(), m.y_axis.y(),
+		m.origin.x(), m.origin.y());
+	touched |= transformation;
+	return *this;
+}
+
+sketch& sketch::reset_matrix() noexcept
+{
+	nvgResetTransform(context);
+	return *this;
+}
+
+sketch& sketch::push_matrix() noexcept
+{
+	assert(matrix_depth < max_matrix_depth);
+	matrix_stack[matrix_depth++] = current_matrix();
+	return *this;
+}
+
+sketch& sketch::pop_matrix() noexcept
+{
+	assert(matrix_depth > 0);
+	nvgResetTransform(context);
+	return transform(matrix_stack[--matrix_depth]);
+}
+
+matrix sketch::current_matrix() const noexcept
+{
+	float t[6];
+	nvgCurrentTransform(context, t);
+	return {float2(t[0], t[1]), float2(t[2], t[3]), float2(t[4], t[5])};
+}
+
 sketch& sketch::fill(const paint& paint) noexcept
 {
 	nvgFillPaint(context, paint.raw);
+	touched |= fill_paint;
 	return fill();
 }
 
 sketch& sketch::fill(const rgba_vector& color) noexcept
 {
 	nvgFillColor(context, nvgRGBAf(color.r(), color.g(), color.b(), color.a()));
+	touched |= fill_paint;
 	return fill();
 }
 
@@ -258,6 +539,11 @@ sketch& sketch::fill(const rgba_pixel& color) noexcept
 
 sketch& sketch::fill() noexcept
 {
+	if(!(touched & fill_paint))
+	{
+		nvgFillColor(context, nvgRGBA(255,255,255,255));
+		touched |= fill_paint;
+	}
 	nvgFill(context);
 	return *this;
 }
@@ -265,36 +551,42 @@ sketch& sketch::fill() noexcept
 sketch& sketch::line_cap(cap c) noexcept
 {
 	nvgLineCap(context, support::to_integer(c));
+	touched |= stroke_cap;
 	return *this;
 }
 
 sketch& sketch::line_join(join j) noexcept
 {
 	nvgLineJoin(context, support::to_integer(j));
+	touched |= stroke_join;
 	return *this;
 }
 
 sketch& sketch::line_width(float width) noexcept
 {
 	nvgStrokeWidth(context, width);
+	touched |= stroke_width;
 	return *this;
 }
 
 sketch& sketch::miter_limit(float limit) noexcept
 {
 	nvgMiterLimit(context, limit);
+	touched |= stroke_miter;
 	return *this;
 }
 
 sketch& sketch::outline(const paint& paint) noexcept
 {
 	nvgStrokePaint(context, paint.raw);
+	touched |= stroke_paint;
 	return outline();
 }
 
 sketch& sketch::outline(const rgba_vector& color) noexcept
 {
 	nvgStrokeColor(context, nvgRGBAf(color.r(), color.g(), color.b(), color.a()));
+	touched |= stroke_paint;
 	return outline();
 }
 
@@ -305,6 +597,11 @@ sketch& sketch::outline(const rgba_pixel& color) noexcept
 
 sketch& sketch::outline() noexcept
 {
+	if(!(touched & stroke_paint))
+	{
+		nvgStrokeColor(context, nvgRGBA(0,0,0,255));
+		touched |= stroke_paint;
+	}
 	nvgStroke(context);
 	return *this;
 }
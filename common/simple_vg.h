@@ -2,7 +2,19 @@
 #define SIMPLE_VG_H
 
 #include <memory>
+#include <array>
+#include <cstddef>
 #include "nanovg_full.h"
+// drawing on the CPU needs something to draw
+#if defined SIMPLE_VG_RASTER && !defined SIMPLE_VG_RECORD
+#define SIMPLE_VG_RECORD
+#endif
+#if defined SIMPLE_VG_RECORD
+#include "simple_vg_record.h"
+#endif
+#if defined SIMPLE_VG_RASTER
+#include "simple_vg_raster.h"
+#endif
 #include "simple/support/enum_flags_operators.hpp"
 #include "simple/geom/vector.hpp"
 #include "simple/graphical/color_vector.hpp"
@@ -25,6 +37,24 @@ namespace simple::vg
 	class framebuffer;
 	class sketch;
 
+	// an affine transform, the images of the axes and of the origin,
+	// to build once and hand to sketch::transform every frame
+	struct matrix
+	{
+		float2 x_axis = float2::i();
+		float2 y_axis = float2::j();
+		float2 origin = float2::zero();
+
+		static matrix translation(float2) noexcept;
+		// by twice the angle of the vector, that's what protractor::tau gives
+		static matrix rotation(float2 half_angle) noexcept;
+		static matrix scaling(float2) noexcept;
+
+		float2 operator()(float2) const noexcept;
+		// (a * b)(v) is a(b(v))
+		matrix operator*(const matrix&) const noexcept;
+	};
+
 	class paint
 	{
 		NVGpaint raw;
@@ -60,6 +90,10 @@ namespace simple::vg
 		frame begin_frame(float2 size, float pixelRatio = 1) noexcept;
 		frame begin_frame(framebuffer&) const noexcept;
 
+#if defined SIMPLE_VG_RECORD
+		record::recorder& recorder() const noexcept;
+#endif
+
 		private:
 
 		struct deleter
@@ -102,12 +136,23 @@ namespace simple::vg
 		vg::paint paint(float opacity = 1, float angle = 0) const;
 		private:
 
+#if defined SIMPLE_VG_RECORD
+		// just an image in the recorder
+		struct raw_framebuffer
+		{
+			NVGcontext* context;
+			int image;
+		};
+#else
+		using raw_framebuffer = NVGLUframebuffer;
+#endif
+
 		struct deleter
 		{
-			void operator()(NVGLUframebuffer*) const noexcept;
+			void operator()(raw_framebuffer*) const noexcept;
 		};
 
-		std::unique_ptr<NVGLUframebuffer, deleter> raw;
+		std::unique_ptr<raw_framebuffer, deleter> raw;
 
 		friend class frame;
 	};
@@ -151,12 +196,30 @@ namespace simple::vg
 			sketch& rectangle(const range2f&) noexcept;
 			sketch& line(float2 from, float2 to) noexcept;
 			sketch& arc(float2 center, rangef angle, float radius) noexcept;
-			sketch& arc(float2 center, float2 radius, float tau_factor, float anchor = 0) noexcept; // TODO
+			// a polygon along an ellipse, from anchor to anchor + tau_factor, both in turns,
+			// with as many vertices as it takes to stay within a quarter of a device pixel,
+			// the directions come from a protractor table and a rotor, no radians or trig
+			sketch& arc(float2 center, float2 radius, float tau_factor, float anchor = 0) noexcept;
+			// count concentric arcs, radius, radius + spacing, and so on, each its own sub path,
+			// with the directions worked out once for all of them
+			sketch& arcs(float2 center, float radius, float spacing, unsigned count,
+				float tau_factor, float anchor = 0) noexcept;
 			sketch& move(float2) noexcept;
 			sketch& vertex(float2) noexcept;
 
+			// each one applies before the ones already there,
+			// paints take the transform that is current when they are set,
+			// it all goes back to identity when the sketch ends
+			sketch& translate(float2) noexcept;
+			sketch& rotate(float2 half_angle) noexcept;
 			sketch& scale(float2) noexcept;
+			sketch& transform(const matrix&) noexcept;
 			sketch& reset_matrix() noexcept;
+			// just the transform, not the rest of the state nvgSave would copy,
+			// a few levels deep, enough for nesting parts of a drawing
+			sketch& push_matrix() noexcept;
+			sketch& pop_matrix() noexcept;
+			matrix current_matrix() const noexcept;
 
 			sketch& fill(const paint&) noexcept;
 			sketch& fill(const rgba_vector&) noexcept;
@@ -175,8 +238,31 @@ namespace simple::vg
 			sketch(sketch&&) noexcept;
 			~sketch() noexcept;
 		private:
+			// the parts of the state this sketch changed, the rest of the frame
+			// expects nanovg's defaults, so only these are put back, instead of
+			// saving and restoring the whole state for every sketch,
+			// paints are only ever set right before they are used, so they are never put back
+			enum touched_state : unsigned
+			{
+				fill_paint = 1 << 0,
+				stroke_paint = 1 << 1,
+				stroke_width = 1 << 2,
+				stroke_miter = 1 << 3,
+				stroke_cap = 1 << 4,
+				stroke_join = 1 << 5,
+				transformation = 1 << 6
+			};
+
 			NVGcontext* context;
-			sketch(NVGcontext*) noexcept;
+			float pixel_ratio;
+			unsigned touched = 0;
+			static constexpr std::size_t max_matrix_depth = 8;
+			std::array<matrix, max_matrix_depth> matrix_stack;
+			std::size_t matrix_depth = 0;
+			sketch(NVGcontext*, float pixel_ratio) noexcept;
+			void reset() noexcept;
+			// how big a unit of this sketch comes out in device pixels, at most
+			float device_scale() const noexcept;
 			friend class frame;
 	};
 
@@ -0,0 +1,761 @@
+#include "simple_vg_raster.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace simple::vg;
+using namespace simple::vg::raster;
+
+namespace
+{
+	constexpr int tile_size = rasterizer::tile_size;
+	// coverage rows spill up to two past the edge of the tile
+	constexpr int area_stride = tile_size + 2;
+
+	// same as nanovg's transforms, [a b c d e f] is
+	// x' = a*x + c*y + e
+	// y' = b*x + d*y + f
+
+	void apply(const float* t, float x, float y, float& out_x, float& out_y) noexcept
+	{
+		out_x = t[0]*x + t[2]*y + t[4];
+		out_y = t[1]*x + t[3]*y + t[5];
+	}
+
+	// t = s after t
+	void multiply(float* t, const float* s) noexcept
+	{
+		const float t0 = t[0] * s[0] + t[1] * s[2];
+		const float t2 = t[2] * s[0] + t[3] * s[2];
+		const float t4 = t[4] * s[0] + t[5] * s[2] + s[4];
+		t[1] = t[0] * s[1] + t[1] * s[3];
+		t[3] = t[2] * s[1] + t[3] * s[3];
+		t[5] = t[4] * s[1] + t[5] * s[3] + s[5];
+		t[0] = t0;
+		t[2] = t2;
+		t[4] = t4;
+	}
+
+	void inverse(float* inv, const float* t) noexcept
+	{
+		const double det = double(t[0]) * t[3] - double(t[2]) * t[1];
+		if(det > -1e-6 && det < 1e-6)
+		{
+			const float identity[6] = {1,0, 0,1, 0,0};
+			std::copy(identity, identity + 6, inv);
+			return;
+		}
+		const double invdet = 1.0 / det;
+		inv[0] = float(t[3] * invdet);
+		inv[2] = float(-t[2] * invdet);
+		inv[4] = float((double(t[2]) * t[5] - double(t[3]) * t[4]) * invdet);
+		inv[1] = float(-t[1] * invdet);
+		inv[3] = float(t[0] * invdet);
+		inv[5] = float((double(t[1]) * t[4] - double(t[0]) * t[5]) * invdet);
+	}
+
+	float clamp01(float value) noexcept
+	{
+		return std::min(std::max(value, 0.f), 1.f);
+	}
+
+	void premultiply(const NVGcolor& color, float* out) noexcept
+	{
+		out[0] = color.r * color.a;
+		out[1] = color.g * color.a;
+		out[2] = color.b * color.a;
+		out[3] = color.a;
+	}
+
+	// signed distance to a rounded rectangle centered at origin
+	float rounded_rect_distance(float x, float y, const float* extent, float radius) noexcept
+	{
+		const float dx = std::abs(x) - (extent[0] - radius);
+		const float dy = std::abs(y) - (extent[1] - radius);
+		const float outside_x = std::max(dx, 0.f);
+		const float outside_y = std::max(dy, 0.f);
+		return std::min(std::max(dx, dy), 0.f)
+			+ std::sqrt(outside_x*outside_x + outside_y*outside_y) - radius;
+	}
+
+	int wrap_texel(int i, int size, bool repeat) noexcept
+	{
+		if(repeat)
+		{
+			i %= size;
+			return i < 0 ? i + size : i;
+		}
+		return std::min(std::max(i, 0), size - 1);
+	}
+
+	// the blend factor of one channel, colors are premultiplied
+	float factor(int op, int channel, const float* source, const float* destination) noexcept
+	{
+		switch(op)
+		{
+			case NVG_ZERO: return 0;
+			case NVG_ONE: return 1;
+			case NVG_SRC_COLOR: return source[channel];
+			case NVG_ONE_MINUS_SRC_COLOR: return 1 - source[channel];
+			case NVG_DST_COLOR: return destination[channel];
+			case NVG_ONE_MINUS_DST_COLOR: return 1 - destination[channel];
+			case NVG_SRC_ALPHA: return source[3];
+			case NVG_ONE_MINUS_SRC_ALPHA: return 1 - source[3];
+			case NVG_DST_ALPHA: return destination[3];
+			case NVG_ONE_MINUS_DST_ALPHA: return 1 - destination[3];
+			case NVG_SRC_ALPHA_SATURATE:
+				return channel == 3 ? 1 : std::min(source[3], 1 - destination[3]);
+		}
+		return 0;
+	}
+
+	// adds the signed area between the line and the left side of the tile into
+	// the pixels it crosses, so that the running sum along a row is the coverage,
+	// this is how font-rs does it,
+	// expects y0 < y1, and x already within the tile
+	void accumulate_line(float* area, int height, float direction,
+		float x0, float y0, float x1, float y1) noexcept
+	{
+		const float dxdy = (x1 - x0) / (y1 - y0);
+		float x = x0;
+		if(y0 < 0)
+		{
+			x = std::min(std::max(x - y0 * dxdy, 0.f), float(tile_size));
+			y0 = 0;
+		}
+		const int last_row = std::min(height, int(std::ceil(y1)));
+		for(int y = int(y0); y < last_row; ++y)
+		{
+			float* row = area + y * area_stride;
+			const float dy = std::min(float(y + 1), y1) - std::max(float(y), y0);
+			const float next = std::min(std::max(x + dxdy * dy, 0.f), float(tile_size));
+			const float d = dy * direction;
+			const float left = std::min(x, next);
+			const float right = std::max(x, next);
+			const float left_floor = std::floor(left);
+			const int first = int(left_floor);
+			const float right_ceil = std::ceil(right);
+			const int last = int(right_ceil);
+			if(last <= first + 1)
+			{
+				// within one pixel, split by the middle
+				const float middle = 0.5f * (x + next) - left_floor;
+				row[first] += d - d * middle;
+				row[first + 1] += d * middle;
+			}
+			else
+			{
+				const float slope = 1 / (right - left);
+				const float left_fraction = left - left_floor;
+				const float first_area = 0.5f * slope * (1 - left_fraction) * (1 - left_fraction);
+				const float right_fraction = right - right_ceil + 1;
+				const float last_area = 0.5f * slope * right_fraction * right_fraction;
+				row[first] += d * first_area;
+				if(last == first + 2)
+					row[first + 1] += d * (1 - first_area - last_area);
+				else
+				{
+					const float second_area = slope * (1.5f - left_fraction);
+					row[first + 1] += d * (second_area - first_area);
+					for(int i = first + 2; i < last - 1; ++i)
+						row[i] += d * slope;
+					const float before_last = second_area + (last - first - 3) * slope;
+					row[last - 1] += d * (1 - before_last - last_area);
+				}
+				row[last] += d * last_area;
+			}
+			x = next;
+		}
+	}
+
+	// clips the line to the tile, tile coordinates,
+	// whatever is to the left of the tile covers the whole row,
+	// so it's moved onto the left side, whatever is to the right doesn't matter
+	void accumulate(float* area, int height, float x0, float y0, float x1, float y1) noexcept
+	{
+		if(y0 == y1)
+			return;
+		float direction = 1;
+		if(y0 > y1)
+		{
+			std::swap(x0, x1);
+			std::swap(y0, y1);
+			direction = -1;
+		}
+		if(y1 <= 0 || y0 >= height)
+			return;
+		if(x0 >= tile_size && x1 >= tile_size)
+			return;
+		constexpr float right = tile_size;
+		if(x0 >= 0 && x1 >= 0 && x0 <= right && x1 <= right)
+		{
+			accumulate_line(area, height, direction, x0, y0, x1, y1);
+			return;
+		}
+
+		// cut where it crosses the sides, in order along the line
+		float cuts[4] = {0};
+		int count = 1;
+		const float dx = x1 - x0;
+		if(dx != 0)
+		{
+			float sides[2] = {-x0 / dx, (right - x0) / dx};
+			if(sides[0] > sides[1])
+				std::swap(sides[0], sides[1]);
+			for(float t : sides)
+				if(t > 0 && t < 1)
+					cuts[count++] = t;
+		}
+		cuts[count++] = 1;
+		const float dy = y1 - y0;
+		for(int i = 0; i + 1 < count; ++i)
+		{
+			const float a = cuts[i], b = cuts[i+1];
+			const float piece_y0 = y0 + dy * a, piece_y1 = y0 + dy * b;
+			if(piece_y0 >= piece_y1)
+				continue;
+			const float piece_x0 = std::min(std::max(x0 + dx * a, 0.f), right);
+			const float piece_x1 = std::min(std::max(x0 + dx * b, 0.f), right);
+			accumulate_line(area, height, direction, piece_x0, piece_y0, piece_x1, piece_y1);
+		}
+	}
+
+	// a triangle always wound the same way, so that triangles of a strip
+	// share edges that cancel out, and overlapping ones just add up
+	void accumulate_triangle(float* area, int height, float offset_x, float offset_y, float scale,
+		const NVGvertex& a, const NVGvertex& b, const NVGvertex& c) noexcept
+	{
+		float ax = a.x * scale - offset_x, ay = a.y * scale - offset_y;
+		float bx = b.x * scale - offset_x, by = b.y * scale - offset_y;
+		float cx = c.x * scale - offset_x, cy = c.y * scale - offset_y;
+		const float winding = (bx - ax) * (cy - ay) - (by - ay) * (cx - ax);
+		if(winding == 0)
+			return;
+		if(winding < 0)
+		{
+			std::swap(bx, cx);
+			std::swap(by, cy);
+		}
+		accumulate(area, height, ax, ay, bx, by);
+		accumulate(area, height, bx, by, cx, cy);
+		accumulate(area, height, cx, cy, ax, ay);
+	}
+
+	struct scratch
+	{
+		std::vector<float> area;
+		std::vector<float> coverage;
+		// planar, a tile of each channel
+		std::vector<float> color;
+
+		scratch() :
+			area(area_stride * (tile_size + 1)),
+			coverage(tile_size),
+			color(4 * tile_size * tile_size)
+		{}
+	};
+
+} // namespace
+
+// what it takes to color a pixel, set up once per command
+struct rasterizer::shader
+{
+	enum class kind
+	{
+		solid,
+		gradient,
+		image
+	};
+
+	kind type = kind::solid;
+	float paint[6]; // inverse of the paint transform
+	float extent[2];
+	float radius;
+	float feather;
+	float inner[4];
+	float outer[4];
+
+	const record::image* image = nullptr;
+	int texture_type = 0; // premultiplied, straight or alpha, same as the GL backend
+
+	bool scissored = false;
+	float scissor[6];
+	float scissor_extent[2];
+	float scissor_scale[2];
+
+	NVGcompositeOperationState composite;
+	// the usual premultiplied source over, has its own quicker loop
+	bool over = false;
+
+	void color(float x, float y, float* out) const noexcept
+	{
+		float px, py;
+		apply(paint, x, y, px, py);
+
+		if(type == kind::gradient)
+		{
+			const float d = clamp01((rounded_rect_distance(px, py, extent, radius) + feather*0.5f) / feather);
+			for(int i = 0; i < 4; ++i)
+				out[i] = inner[i] + (outer[i] - inner[i]) * d;
+			return;
+		}
+
+		if(type == kind::image)
+		{
+			sample(px / extent[0], py / extent[1], out);
+			if(texture_type == 1)
+				for(int i = 0; i < 3; ++i)
+					out[i] *= out[3];
+			else if(texture_type == 2)
+				out[0] = out[1] = out[2] = out[3];
+			for(int i = 0; i < 4; ++i)
+				out[i] *= inner[i];
+			return;
+		}
+
+		std::copy(inner, inner + 4, out);
+	}
+
+	float clip(float x, float y) const noexcept
+	{
+		if(!scissored)
+			return 1;
+		float sx, sy;
+		apply(scissor, x, y, sx, sy);
+		sx = 0.5f - (std::abs(sx) - scissor_extent[0]) * scissor_scale[0];
+		sy = 0.5f - (std::abs(sy) - scissor_extent[1]) * scissor_scale[1];
+		return clamp01(sx) * clamp01(sy);
+	}
+
+	private:
+
+	void texel(int x, int y, float* out) const noexcept
+	{
+		const bool rgba = image->type == NVG_TEXTURE_RGBA;
+		const int channels = rgba ? 4 : 1;
+		const auto* pixel = image->pixels.data() + (std::size_t(y) * image->width + x) * channels;
+		for(int i = 0; i < 4; ++i)
+			out[i] = pixel[rgba ? i : 0] / 255.f;
+	}
+
+	void sample(float u, float v, float* out) const noexcept
+	{
+		const int width = image->width, height = image->height;
+		const bool repeat_x = image->flags & NVG_IMAGE_REPEATX;
+		const bool repeat_y = image->flags & NVG_IMAGE_REPEATY;
+
+		if(image->flags & NVG_IMAGE_NEAREST)
+		{
+			texel(
+				wrap_texel(int(std::floor(u * width)), width, repeat_x),
+				wrap_texel(int(std::floor(v * height)), height, repeat_y),
+				out);
+			return;
+		}
+
+		const float fx = u * width - 0.5f, fy = v * height - 0.5f;
+		const float floor_x = std::floor(fx), floor_y = std::floor(fy);
+		const float tx = fx - floor_x, ty = fy - floor_y;
+		const int x0 = wrap_texel(int(floor_x), width, repeat_x);
+		const int x1 = wrap_texel(int(floor_x) + 1, width, repeat_x);
+		const int y0 = wrap_texel(int(floor_y), height, repeat_y);
+		const int y1 = wrap_texel(int(floor_y) + 1, height, repeat_y);
+		float a[4], b[4], c[4], d[4];
+		texel(x0, y0, a);
+		texel(x1, y0, b);
+		texel(x0, y1, c);
+		texel(x1, y1, d);
+		for(int i = 0; i < 4; ++i)
+		{
+			const float top = a[i] + (b[i] - a[i]) * tx;
+			const float bottom = c[i] + (d[i] - c[i]) * tx;
+			out[i] = top + (bottom - top) * ty;
+		}
+	}
+};
+
+struct rasterizer::prepared
+{
+	record::command::kind type;
+	// pixels, [x0,y0, x1,y1) within the target, empty when there's nothing to draw
+	int bounds[4];
+	std::size_t first;
+	std::size_t last;
+	shader paint;
+	// clear color, as is, not premultiplied, like glClearColor
+	float clear[4];
+
+	bool empty() const noexcept { return bounds[0] >= bounds[2] || bounds[1] >= bounds[3]; }
+};
+
+rasterizer::rasterizer(record::recorder& recorder, common::thread_pool& jobs) :
+	recorder(recorder),
+	jobs(jobs)
+{
+	recorder.flushed = [this](record::recorder&) { flush(); };
+}
+
+rasterizer::~rasterizer()
+{
+	recorder.flushed = nullptr;
+}
+
+std::vector<unsigned char> rasterizer::snapshot() const
+{
+	auto pixels = screen;
+	for(std::size_t i = 0; i < pixels.size(); i += 4)
+	{
+		const unsigned alpha = pixels[i+3];
+		if(alpha == 0 || alpha == 255)
+			continue;
+		for(std::size_t c = i; c < i + 3; ++c)
+			pixels[c] = std::min(pixels[c] * 255u / alpha, 255u);
+	}
+	return pixels;
+}
+
+void rasterizer::flush()
+{
+	const int width = int(std::ceil(recorder.screen_width * recorder.pixel_ratio));
+	const int height = int(std::ceil(recorder.screen_height * recorder.pixel_ratio));
+	if(width != screen_width || height != screen_height)
+	{
+		screen_width = width;
+		screen_height = height;
+		screen.assign(std::size_t(width) * height * 4, 0);
+	}
+
+	// consecutive commands with the same target go together,
+	// one target is done before the next one can sample it
+	const auto& all = recorder.commands();
+	std::size_t first = 0;
+	while(first < all.size())
+	{
+		const int id = all[first].target;
+		std::size_t last = first;
+		while(last < all.size() && all[last].target == id)
+			++last;
+
+		if(id == 0)
+		{
+			if(!screen.empty())
+				draw(first, last, {screen.data(), screen_width, screen_height, 4, false, recorder.pixel_ratio});
+		}
+		else if(auto image = recorder.find_image(id); image && image->type == NVG_TEXTURE_RGBA)
+			draw(first, last, {image->pixels.data(), image->width, image->height, 4, true, 1});
+
+		first = last;
+	}
+}
+
+rasterizer::prepared rasterizer::prepare(const record::command& command, const target& target) const
+{
+	prepared p{};
+	p.type = command.type;
+
+	if(command.type == record::command::kind::clear)
+	{
+		p.bounds[2] = target.width;
+		p.bounds[3] = target.height;
+		std::copy(command.paint.innerColor.rgba, command.paint.innerColor.rgba + 4, p.clear);
+		return p;
+	}
+
+	p.first = command.first;
+	p.last = command.last;
+
+	// bounds of all the vertices
+	const auto& vertices = recorder.vertices();
+	const auto& paths = recorder.paths();
+	float lower[2] = {INFINITY, INFINITY}, upper[2] = {-INFINITY, -INFINITY};
+	const auto extend = [&](std::size_t first, std::size_t last)
+	{
+		for(auto v = first; v < last; ++v)
+		{
+			lower[0] = std::min(lower[0], vertices[v].x);
+			lower[1] = std::min(lower[1], vertices[v].y);
+			upper[0] = std::max(upper[0], vertices[v].x);
+			upper[1] = std::max(upper[1], vertices[v].y);
+		}
+	};
+	if(command.type == record::command::kind::triangles)
+		extend(command.first, command.last);
+	else
+		for(auto i = command.first; i < command.last; ++i)
+			extend(paths[i].first, paths[i].last);
+
+	if(lower[0] <= upper[0])
+	{
+		p.bounds[0] = std::max(int(std::floor(lower[0] * target.scale)), 0);
+		p.bounds[1] = std::max(int(std::floor(lower[1] * target.scale)), 0);
+		p.bounds[2] = std::min(int(std::ceil(upper[0] * target.scale)), target.width);
+		p.bounds[3] = std::min(int(std::ceil(upper[1] * target.scale)), target.height);
+	}
+
+	// the rest is what the GL backend passes to its shader
+	auto& s = p.paint;
+	const auto& paint = command.paint;
+	s.composite = command.composite;
+	s.over = s.composite.srcRGB == NVG_ONE && s.composite.srcAlpha == NVG_ONE &&
+		s.composite.dstRGB == NVG_ONE_MINUS_SRC_ALPHA && s.composite.dstAlpha == NVG_ONE_MINUS_SRC_ALPHA;
+
+	premultiply(paint.innerColor, s.inner);
+	premultiply(paint.outerColor, s.outer);
+	s.extent[0] = paint.extent[0];
+	s.extent[1] = paint.extent[1];
+	s.radius = paint.radius;
+	s.feather = paint.feather;
+
+	s.image = paint.image ? recorder.find_image(paint.image) : nullptr;
+	if(s.image)
+	{
+		s.type = shader::kind::image;
+		s.texture_type = s.image->type == NVG_TEXTURE_RGBA
+			? (s.image->flags & NVG_IMAGE_PREMULTIPLIED ? 0 : 1)
+			: 2;
+		if(s.image->flags & NVG_IMAGE_FLIPY)
+		{
+			float flipped[6] = {1,0, 0,1, 0,s.extent[1]*0.5f};
+			multiply(flipped, paint.xform);
+			float transform[6] = {1,0, 0,-1, 0,0};
+			multiply(transform, flipped);
+			float back[6] = {1,0, 0,1, 0,-s.extent[1]*0.5f};
+			multiply(back, transform);
+			inverse(s.paint, back);
+		}
+		else
+			inverse(s.paint, paint.xform);
+	}
+	else
+	{
+		s.type = std::equal(s.inner, s.inner + 4, s.outer) ? shader::kind::solid : shader::kind::gradient;
+		inverse(s.paint, paint.xform);
+	}
+
+	const auto& scissor = command.scissor;
+	s.scissored = !(scissor.extent[0] < -0.5f || scissor.extent[1] < -0.5f);
+	if(s.scissored)
+	{
+		const float fringe = command.fringe > 0 ? command.fringe : 1;
+		inverse(s.scissor, scissor.xform);
+		s.scissor_extent[0] = scissor.extent[0];
+		s.scissor_extent[1] = scissor.extent[1];
+		s.scissor_scale[0] = std::sqrt(scissor.xform[0]*scissor.xform[0] + scissor.xform[2]*scissor.xform[2]) / fringe;
+		s.scissor_scale[1] = std::sqrt(scissor.xform[1]*scissor.xform[1] + scissor.xform[3]*scissor.xform[3]) / fringe;
+	}
+
+	return p;
+}
+
+void rasterizer::draw(std::size_t first, std::size_t last, const target& target)
+{
+	const auto& all = recorder.commands();
+	commands.clear();
+	for(auto i = first; i < last; ++i)
+		commands.push_back(prepare(all[i], target));
+
+	const int columns = target.columns();
+	const int tiles = columns * target.rows();
+	if(bins.size() < std::size_t(tiles))
+		bins.resize(tiles);
+	for(int i = 0; i < tiles; ++i)
+		bins[i].clear();
+
+	for(unsigned i = 0; i < commands.size(); ++i)
+	{
+		const auto& c = commands[i];
+		if(c.empty())
+			continue;
+		for(int row = c.bounds[1] / tile_size; row <= (c.bounds[3] - 1) / tile_size; ++row)
+			for(int column = c.bounds[0] / tile_size; column <= (c.bounds[2] - 1) / tile_size; ++column)
+				bins[row * columns + column].push_back(i);
+	}
+
+	jobs.parallel_for(0, tiles, 1, [&](std::size_t first, std::size_t last)
+	{
+		for(auto tile = first; tile < last; ++tile)
+			draw_tile(target, tile % columns, tile / columns);
+	});
+}
+
+void rasterizer::draw_tile(const target& target, int column, int row)
+{
+	const auto& bin = bins[row * target.columns() + column];
+	if(bin.empty())
+		return;
+
+	thread_local scratch local;
+	float* area = local.area.data();
+	float* coverage = local.coverage.data();
+	float* const color[4] = {
+		local.color.data(),
+		local.color.data() + tile_size*tile_size,
+		local.color.data() + tile_size*tile_size*2,
+		local.color.data() + tile_size*tile_size*3
+	};
+
+	const int origin_x = column * tile_size;
+	const int origin_y = row * tile_size;
+	const int width = std::min(tile_size, target.width - origin_x);
+	const int height = std::min(tile_size, target.height - origin_y);
+
+	const auto pixel_row = [&](int y)
+	{
+		const int target_y = target.flipped ? target.height - 1 - (origin_y + y) : origin_y + y;
+		return target.pixels + (std::size_t(target_y) * target.width + origin_x) * target.channels;
+	};
+
+	// most frames start with a clear, then there's nothing to load
+	if(commands[bin.front()].type != record::command::kind::clear)
+		for(int y = 0; y < height; ++y)
+		{
+			const unsigned char* pixels = pixel_row(y);
+			for(int x = 0; x < width; ++x)
+				for(int c = 0; c < 4; ++c)
+					color[c][y * tile_size + x] = pixels[x * 4 + c] * (1 / 255.f);
+		}
+
+	const auto& vertices = recorder.vertices();
+	const auto& paths = recorder.paths();
+
+	for(auto index : bin)
+	{
+		const auto& command = commands[index];
+
+		if(command.type == record::command::kind::clear)
+		{
+			for(int c = 0; c < 4; ++c)
+				std::fill(color[c], color[c] + tile_size*tile_size, command.clear[c]);
+			continue;
+		}
+
+		// the part of the command's bounds within the tile
+		const int x0 = std::max(command.bounds[0] - origin_x, 0);
+		const int y0 = std::max(command.bounds[1] - origin_y, 0);
+		const int x1 = std::min(command.bounds[2] - origin_x, width);
+		const int y1 = std::min(command.bounds[3] - origin_y, height);
+		if(x0 >= x1 || y0 >= y1)
+			continue;
+
+		for(int y = y0; y < y1; ++y)
+			std::fill(area + y * area_stride, area + (y + 1) * area_stride, 0.f);
+
+		const float scale = target.scale;
+		const float offset_x = origin_x, offset_y = origin_y;
+		switch(command.type)
+		{
+			case record::command::kind::fill:
+				// outlines, nonzero
+				for(auto p = command.first; p < command.last; ++p)
+				{
+					const auto& path = paths[p];
+					if(path.last - path.first < 3)
+						continue;
+					auto previous = path.last - 1;
+					for(auto v = path.first; v < path.last; previous = v++)
+						accumulate(area, y1,
+							vertices[previous].x * scale - offset_x, vertices[previous].y * scale - offset_y,
+							vertices[v].x * scale - offset_x, vertices[v].y * scale - offset_y);
+				}
+			break;
+
+			case record::command::kind::stroke:
+				// triangle strips
+				for(auto p = command.first; p < command.last; ++p)
+				{
+					const auto& path = paths[p];
+					for(auto v = path.first; v + 2 < path.last; ++v)
+						accumulate_triangle(area, y1, offset_x, offset_y, scale,
+							vertices[v], vertices[v+1], vertices[v+2]);
+				}
+			break;
+
+			case record::command::kind::triangles:
+				for(auto v = command.first; v + 2 < command.last; v += 3)
+					accumulate_triangle(area, y1, offset_x, offset_y, scale,
+						vertices[v], vertices[v+1], vertices[v+2]);
+			break;
+
+			case record::command::kind::clear: break;
+		}
+
+		const auto& paint = command.paint;
+		for(int y = y0; y < y1; ++y)
+		{
+			// the running sum is the signed coverage,
+			// more than one winding is still just covered
+			const float* row = area + y * area_stride;
+			float sum = 0;
+			bool any = false;
+			for(int x = x0; x < x1; ++x)
+			{
+				sum += row[x];
+				coverage[x] = std::min(std::abs(sum), 1.f);
+				any |= coverage[x] > 0.f;
+			}
+			if(!any)
+				continue;
+
+			const float center_y = (origin_y + y + 0.5f) / scale;
+			if(paint.scissored)
+				for(int x = x0; x < x1; ++x)
+					coverage[x] *= paint.clip((origin_x + x + 0.5f) / scale, center_y);
+
+			float* r = color[0] + y * tile_size;
+			float* g = color[1] + y * tile_size;
+			float* b = color[2] + y * tile_size;
+			float* a = color[3] + y * tile_size;
+
+			if(paint.type == shader::kind::solid && paint.over)
+			{
+				// the common case, plain loop with no branches to vectorize
+				const float sr = paint.inner[0], sg = paint.inner[1], sb = paint.inner[2], sa = paint.inner[3];
+				for(int x = x0; x < x1; ++x)
+				{
+					const float cover = coverage[x];
+					const float keep = 1 - sa * cover;
+					r[x] = sr * cover + r[x] * keep;
+					g[x] = sg * cover + g[x] * keep;
+					b[x] = sb * cover + b[x] * keep;
+					a[x] = sa * cover + a[x] * keep;
+				}
+				continue;
+			}
+
+			for(int x = x0; x < x1; ++x)
+			{
+				const float cover = coverage[x];
+				if(cover <= 0)
+					continue;
+				float source[4]{};
+				paint.color((origin_x + x + 0.5f) / scale, center_y, source);
+				for(auto& channel : source)
+					channel *= cover;
+
+				const float destination[4] = {r[x], g[x], b[x], a[x]};
+				float* out[4] = {r + x, g + x, b + x, a + x};
+				if(paint.over)
+				{
+					for(int c = 0; c < 4; ++c)
+						*out[c] = source[c] + destination[c] * (1 - source[3]);
+					continue;
+				}
+				const auto& op = paint.composite;
+				for(int c = 0; c < 4; ++c)
+				{
+					const int source_op = c == 3 ? op.srcAlpha : op.srcRGB;
+					const int destination_op = c == 3 ? op.dstAlpha : op.dstRGB;
+					*out[c] = source[c] * factor(source_op, c, source, destination)
+						+ destination[c] * factor(destination_op, c, source, destination);
+				}
+			}
+		}
+	}
+
+	for(int y = 0; y < height; ++y)
+	{
+		unsigned char* pixels = pixel_row(y);
+		for(int x = 0; x < width; ++x)
+			for(int c = 0; c < 4; ++c)
+				pixels[x * 4 + c] = static_cast<unsigned char>(clamp01(color[c][y * tile_size + x]) * 255.f + 0.5f);
+	}
+}
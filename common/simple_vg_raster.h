@@ -0,0 +1,80 @@
+#ifndef SIMPLE_VG_RASTER_H
+#define SIMPLE_VG_RASTER_H
+
+#include <vector>
+#include <cstddef>
+#include "simple_vg_record.h"
+#include "parallel.hpp"
+
+// draws what the recording backend recorded, on the CPU, into plain RGBA buffers,
+// for when there is no GL around, or to have a picture to look at after a headless run
+//
+// the targets are cut into square tiles, each command is binned into the tiles
+// its bounds touch, and then the tiles are drawn in parallel, each one front to back
+// through its own list, so the order of the commands is kept without any locking
+//
+// coverage is the exact area of the pixel under the shape, accumulated per edge
+// and integrated along the rows, so anti-aliasing comes for free and nanovg's
+// own fringes aren't needed, create the context without NVG_ANTIALIAS
+//
+// paints follow what the GL backend does in its shader, so the same sketch
+// should look the same, give or take the rounding
+namespace simple::vg::raster
+{
+	class rasterizer
+	{
+		public:
+		static constexpr int tile_size = 64;
+
+		// hooks itself into the recorder's flushed callback
+		rasterizer(record::recorder&, common::thread_pool&);
+		~rasterizer();
+		rasterizer(const rasterizer&) = delete;
+		rasterizer& operator=(const rasterizer&) = delete;
+
+		// the screen, premultiplied RGBA, top row first,
+		// in physical pixels, that is the viewport size times pixel ratio
+		int width() const noexcept { return screen_width; }
+		int height() const noexcept { return screen_height; }
+		const std::vector<unsigned char>& pixels() const noexcept { return screen; }
+
+		// the screen with straight alpha, as image files expect it
+		std::vector<unsigned char> snapshot() const;
+
+		private:
+		// a target in tile-sized pieces, images are stored bottom row first,
+		// like GL framebuffers are, so that they sample the same way
+		struct target
+		{
+			unsigned char* pixels;
+			int width;
+			int height;
+			int channels;
+			bool flipped;
+			float scale;
+			int columns() const noexcept { return (width + tile_size - 1) / tile_size; }
+			int rows() const noexcept { return (height + tile_size - 1) / tile_size; }
+		};
+
+		struct shader;
+		struct prepared;
+
+		record::recorder& recorder;
+		common::thread_pool& jobs;
+		std::vector<unsigned char> screen;
+		int screen_width = 0;
+		int screen_height = 0;
+
+		std::vector<prepared> commands;
+		// command indices per tile, in order
+		std::vector<std::vector<unsigned>> bins;
+
+		void flush();
+		void draw(std::size_t first, std::size_t last, const target&);
+		void draw_tile(const target&, int column, int row);
+		prepared prepare(const record::command&, const target&) const;
+	};
+
+} // namespace simple::vg::raster
+
+#endif /* end of include guard */
@@ -0,0 +1,202 @@
+#include "simple_vg_record.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace simple::vg::record;
+
+image* recorder::find_image(int id) noexcept
+{
+	if(id <= 0 || std::size_t(id) > images.size() || !images[id-1].alive)
+		return nullptr;
+	return &images[id-1];
+}
+
+void recorder::clear(NVGcolor color)
+{
+	command c{};
+	c.type = command::kind::clear;
+	c.target = target;
+	c.paint.innerColor = c.paint.outerColor = color;
+	recorded.push_back(c);
+	++stats.clears;
+}
+
+std::size_t recorder::record_paths(const NVGpath* paths, int count, bool fill)
+{
+	const auto first = recorded_paths.size();
+	for(int i = 0; i < count; ++i)
+	{
+		const auto& p = paths[i];
+		const auto vertices = fill ? p.fill : p.stroke;
+		const auto vertex_count = fill ? p.nfill : p.nstroke;
+		recorded_paths.push_back({
+			recorded_vertices.size(),
+			recorded_vertices.size() + vertex_count,
+			bool(p.closed), bool(p.convex)
+		});
+		recorded_vertices.insert(recorded_vertices.end(), vertices, vertices + vertex_count);
+		stats.vertices += vertex_count;
+	}
+	return first;
+}
+
+command& recorder::record(command::kind type, NVGpaint* paint,
+	NVGcompositeOperationState composite, NVGscissor* scissor, float fringe)
+{
+	command c{};
+	c.type = type;
+	c.target = target;
+	c.paint = *paint;
+	c.composite = composite;
+	c.scissor = *scissor;
+	c.fringe = fringe;
+	recorded.push_back(c);
+	return recorded.back();
+}
+
+int recorder::create(void*)
+{
+	return 1;
+}
+
+int recorder::create_texture(void* self, int type, int width, int height, int flags, const unsigned char* data)
+{
+	auto& images = static_cast<recorder*>(self)->images;
+	const std::size_t size = std::size_t(width) * height * (type == NVG_TEXTURE_RGBA ? 4 : 1);
+	images.push_back({type, flags, width, height, std::vector<unsigned char>(size), true});
+	if(data)
+		std::memcpy(images.back().pixels.data(), data, size);
+	return images.size();
+}
+
+int recorder::delete_texture(void* self, int id)
+{
+	auto image = static_cast<recorder*>(self)->find_image(id);
+	if(!image)
+		return 0;
+	image->alive = false;
+	image->pixels = {};
+	return 1;
+}
+
+int recorder::update_texture(void* self, int id, int, int y, int, int height, const unsigned char* data)
+{
+	auto image = static_cast<recorder*>(self)->find_image(id);
+	if(!image)
+		return 0;
+	// same as the GL backend, whole rows, data is the whole image
+	const std::size_t row = std::size_t(image->width) * (image->type == NVG_TEXTURE_RGBA ? 4 : 1);
+	std::memcpy(image->pixels.data() + y * row, data + y * row, height * row);
+	return 1;
+}
+
+int recorder::texture_size(void* self, int id, int* width, int* height)
+{
+	auto image = static_cast<recorder*>(self)->find_image(id);
+	if(!image)
+		return 0;
+	*width = image->width;
+	*height = image->height;
+	return 1;
+}
+
+void recorder::viewport(void* self, float width, float height, float pixel_ratio)
+{
+	auto& r = *static_cast<recorder*>(self);
+	if(r.target != 0)
+		return;
+	r.screen_width = width;
+	r.screen_height = height;
+	r.pixel_ratio = pixel_ratio;
+}
+
+void recorder::cancel(void* self)
+{
+	auto& r = *static_cast<recorder*>(self);
+	r.recorded.clear();
+	r.recorded_paths.clear();
+	r.recorded_vertices.clear();
+}
+
+void recorder::flush(void* self)
+{
+	auto& r = *static_cast<recorder*>(self);
+	++r.stats.frames;
+	if(r.flushed)
+		r.flushed(r);
+	cancel(self);
+}
+
+void recorder::fill(void* self, NVGpaint* paint, NVGcompositeOperationState composite, NVGscissor* scissor,
+	float fringe, const float* bounds, const NVGpath* paths, int count)
+{
+	auto& r = *static_cast<recorder*>(self);
+	auto& c = r.record(command::kind::fill, paint, composite, scissor, fringe);
+	std::copy(bounds, bounds + 4, c.bounds);
+	c.first = r.record_paths(paths, count, true);
+	c.last = r.recorded_paths.size();
+	c.fringe_first = r.record_paths(paths, count, false);
+	c.fringe_last = r.recorded_paths.size();
+	r.stats.paths += count;
+	++r.stats.fills;
+}
+
+void recorder::stroke(void* self, NVGpaint* paint, NVGcompositeOperationState composite, NVGscissor* scissor,
+	float fringe, float width, const NVGpath* paths, int count)
+{
+	auto& r = *static_cast<recorder*>(self);
+	auto& c = r.record(command::kind::stroke, paint, composite, scissor, fringe);
+	c.stroke_width = width;
+	c.first = r.record_paths(paths, count, false);
+	c.last = r.recorded_paths.size();
+	r.stats.paths += count;
+	++r.stats.strokes;
+}
+
+void recorder::triangles(void* self, NVGpaint* paint, NVGcompositeOperationState composite, NVGscissor* scissor,
+	const NVGvertex* vertices, int count, float fringe)
+{
+	auto& r = *static_cast<recorder*>(self);
+	auto& c = r.record(command::kind::triangles, paint, composite, scissor, fringe);
+	c.first = r.recorded_vertices.size();
+	r.recorded_vertices.insert(r.recorded_vertices.end(), vertices, vertices + count);
+	c.last = r.recorded_vertices.size();
+	r.stats.vertices += count;
+	++r.stats.triangles;
+}
+
+void recorder::destroy(void* self)
+{
+	delete static_cast<recorder*>(self);
+}
+
+NVGcontext* simple::vg::record::create(int flags)
+{
+	NVGparams params{};
+	// nanovg deletes it through renderDelete, even if creation fails
+	params.userPtr = new recorder();
+	params.edgeAntiAlias = (flags & NVG_ANTIALIAS) ? 1 : 0;
+	params.renderCreate = recorder::create;
+	params.renderCreateTexture = recorder::create_texture;
+	params.renderDeleteTexture = recorder::delete_texture;
+	params.renderUpdateTexture = recorder::update_texture;
+	params.renderGetTextureSize = recorder::texture_size;
+	params.renderViewport = recorder::viewport;
+	params.renderCancel = recorder::cancel;
+	params.renderFlush = recorder::flush;
+	params.renderFill = recorder::fill;
+	params.renderStroke = recorder::stroke;
+	params.renderTriangles = recorder::triangles;
+	params.renderDelete = recorder::destroy;
+	return nvgCreateInternal(&params);
+}
+
+void simple::vg::record::destroy(NVGcontext* context) noexcept
+{
+	nvgDeleteInternal(context);
+}
+
+recorder& simple::vg::record::of(NVGcontext* context) noexcept
+{
+	return *static_cast<recorder*>(nvgInternalParams(context)->userPtr);
+}
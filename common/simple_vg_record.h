@@ -0,0 +1,134 @@
+#ifndef SIMPLE_VG_RECORD_H
+#define SIMPLE_VG_RECORD_H
+
+#include <vector>
+#include <functional>
+#include <cstddef>
+#include "nanovg.h"
+
+// a nanovg backend that doesn't draw anything by itself,
+// just keeps the tessellated paths nanovg hands to it until the end of the frame,
+// and counts what it was given along the way,
+// to see how much work a sketch makes without needing a GPU
+namespace simple::vg::record
+{
+	struct statistics
+	{
+		unsigned long frames = 0;
+		unsigned long clears = 0;
+		// sketches that had to put some state back
+		unsigned long resets = 0;
+		unsigned long fills = 0;
+		unsigned long strokes = 0;
+		unsigned long triangles = 0;
+		unsigned long paths = 0;
+		unsigned long vertices = 0;
+
+		unsigned long draw_calls() const noexcept { return fills + strokes + triangles; }
+	};
+
+	struct image
+	{
+		int type; // NVG_TEXTURE_ALPHA or NVG_TEXTURE_RGBA
+		int flags;
+		int width;
+		int height;
+		std::vector<unsigned char> pixels;
+		bool alive;
+	};
+
+	// a range of vertices
+	struct path
+	{
+		std::size_t first;
+		std::size_t last;
+		bool closed;
+		bool convex;
+	};
+
+	struct command
+	{
+		enum class kind
+		{
+			clear,
+			fill,
+			stroke,
+			triangles
+		};
+
+		kind type;
+		int target; // image, or 0 for the screen
+		NVGpaint paint; // clear color is the inner color
+		NVGcompositeOperationState composite;
+		NVGscissor scissor;
+		float fringe;
+		float stroke_width;
+		// range of paths, for triangles a range of vertices
+		std::size_t first;
+		std::size_t last;
+		// for fills, the paths are the outlines and
+		// the fringe paths (when antialiased) are right after them
+		std::size_t fringe_first;
+		std::size_t fringe_last;
+		float bounds[4];
+	};
+
+	class recorder
+	{
+		public:
+		statistics stats;
+
+		// called at the end of each frame, before the commands are discarded,
+		// to rasterize them or look into what was drawn
+		std::function<void(recorder&)> flushed;
+
+		const std::vector<command>& commands() const noexcept { return recorded; }
+		const std::vector<path>& paths() const noexcept { return recorded_paths; }
+		const std::vector<NVGvertex>& vertices() const noexcept { return recorded_vertices; }
+
+		// image 0 is not used by nanovg, and here stands for the screen
+		image* find_image(int id) noexcept;
+		float screen_width = 0;
+		float screen_height = 0;
+		float pixel_ratio = 1;
+
+		void bind(int image) noexcept { target = image; }
+		int bound() const noexcept { return target; }
+		void clear(NVGcolor color);
+
+		private:
+		std::vector<command> recorded;
+		std::vector<path> recorded_paths;
+		std::vector<NVGvertex> recorded_vertices;
+		std::vector<image> images;
+		int target = 0;
+
+		std::size_t record_paths(const NVGpath* paths, int count, bool fill);
+		command& record(command::kind, NVGpaint*, NVGcompositeOperationState, NVGscissor*, float fringe);
+
+		static int create(void*);
+		static int create_texture(void*, int type, int width, int height, int flags, const unsigned char* data);
+		static int delete_texture(void*, int image);
+		static int update_texture(void*, int image, int x, int y, int width, int height, const unsigned char* data);
+		static int texture_size(void*, int image, int* width, int* height);
+		static void viewport(void*, float width, float height, float pixel_ratio);
+		static void cancel(void*);
+		static void flush(void*);
+		static void fill(void*, NVGpaint*, NVGcompositeOperationState, NVGscissor*, float fringe,
+			const float* bounds, const NVGpath* paths, int count);
+		static void stroke(void*, NVGpaint*, NVGcompositeOperationState, NVGscissor*, float fringe,
+			float width, const NVGpath* paths, int count);
+		static void triangles(void*, NVGpaint*, NVGcompositeOperationState, NVGscissor*,
+			const NVGvertex* vertices, int count, float fringe);
+		static void destroy(void*);
+
+		friend NVGcontext* create(int flags);
+	};
+
+	NVGcontext* create(int flags);
+	void destroy(NVGcontext*) noexcept;
+	recorder& of(NVGcontext*) noexcept;
+
+} // namespace simple::vg::record
+
+#endif /* end of include guard */
@@ -1,4 +1,5 @@
 #include <cstring>
+#include <cstdlib>
 #include <cstdio>
 #include <thread>
 #include <mutex>
@@ -9,6 +10,9 @@
 #include <array>
 #include <queue>
 #include <list>
+#include <algorithm>
+#include <bitset>
+#include <cmath>
 
 #include "simple/support.hpp"
 #include "simple/graphical.hpp"
@@ -20,6 +24,12 @@
 #include "simple_vg.h"
 #include "simple_vg.cpp" // TODO: woops, don't do this
 #include "math.hpp"
+#include "parallel.hpp"
+#include "mixer.hpp"
+#include "input_log.hpp"
+#if defined SIMPLE_VG_RASTER
+#include "png.hpp"
+#endif
 
 #if defined __EMSCRIPTEN__
 #include <emscripten.h>
@@ -55,7 +65,20 @@ using simple::support::make_range;
 
 constexpr int max_int = std::numeric_limits<int>::max();
 
-support::random::engine::tiny<unsigned> tiny_rand{std::random_device{}};
+// where tiny_rand starts, which a recording keeps, so that its replay gets the same random numbers,
+// right from the start, globals of the sketch that are made with them included
+const common::input_log::seed_type tiny_seed = []()
+{
+#if defined SIMPLE_VG_RECORD
+	if(const char* replay_file = std::getenv("SKETCH_REPLAY"))
+		if(const auto replay = common::read_input_log(replay_file))
+			return replay->seed;
+#endif
+	std::random_device random;
+	return common::input_log::seed_type{random(), random()};
+}();
+
+support::random::engine::tiny<unsigned> tiny_rand{{tiny_seed[0], tiny_seed[1]}};
 support::random::distribution::naive_int<int> tiny_int_dist{0, max_int};
 support::random::distribution::naive_real<float> tiny_float_dist{0, 1};
 
@@ -79,6 +102,28 @@ class framerate
 	constexpr static auto frametime = tick(1);
 };
 
+// keys held down in a replay, there being no keyboard to ask
+std::bitset<512> replayed_keys;
+
+// whether a key is held down, an object rather than a function,
+// so that sketches calling pressed(scancode::...) get this one instead of the one in interactive,
+// which reads the keyboard even when it's a replay that's driving the sketch
+inline constexpr struct
+{
+	bool operator()(scancode key) const
+	{
+#if defined SIMPLE_VG_RECORD
+		const auto code = std::size_t(key);
+		return code < replayed_keys.size() && replayed_keys[code];
+#else
+		return interactive::pressed(key);
+#endif
+	}
+} pressed{};
+
+class Program;
+inline void process_events(Program&);
+
 class Program
 {
 	public:
@@ -93,14 +138,7 @@ class Program
 	using mouse_move_fun = std::function<void(float2, float2)>;
 	using mouse_button_fun = std::function<void(float2, mouse_button)>;
 
-	using wave_fun = std::function<float(float ratio)>;
-	struct wave
-	{
-		wave_fun function;
-		duration total;
-		duration remaining;
-		explicit operator bool() { return bool(function); }
-	};
+	using wave = common::wave<duration>;
 	std::array<wave, 32> waves = {};
 	std::mutex dam;
 
@@ -117,10 +155,17 @@ class Program
 	bool run = true;
 	Program(const int argc, const char * const * const argv) : argc(argc), argv(argv) {}
 
+	// SKETCH_RECORD names the file to record the input to, for replaying it headless later
+	std::optional<common::input_recorder> recorded_input;
+	clock::time_point recording_start;
+
 	public:
 	const int argc;
 	const char * const * const argv;
 
+	// persistent worker threads, for parallel_for-ing through the heavy stuff
+	common::thread_pool jobs;
+
 	std::optional<duration> frametime = std::nullopt;
 	std::string name = "";
 	int2 size = int2(400,400);
@@ -196,20 +241,174 @@ class Program
 	}
 
 	friend int main(int argc, char* argv[]);
+	friend int headless(Program&);
+	friend void process_events(Program&);
 };
 
 template <typename T, motion::curve_t<float> curve = motion::linear_curve<float>>
 using movement = motion::movement<Program::duration, T, float, curve>;
 using motion::melody;
 
-inline void process_events(Program&);
-
 void start(Program&);
 
+// hands the input over to the sketch, live or replayed
+inline void dispatch(Program& program, const common::input_event& event)
+{
+	using kind = common::input_event::kind;
+	switch(event.type)
+	{
+		case kind::key_down:
+#if defined SIMPLE_VG_RECORD
+			if(std::size_t(event.code) < replayed_keys.size())
+				replayed_keys.set(event.code);
+#endif
+			program.key_down(scancode(event.code), keycode(event.key));
+		break;
+		case kind::key_up:
+#if defined SIMPLE_VG_RECORD
+			if(std::size_t(event.code) < replayed_keys.size())
+				replayed_keys.reset(event.code);
+#endif
+			program.key_up(scancode(event.code), keycode(event.key));
+		break;
+		case kind::mouse_down:
+			program.mouse_down(event.position, mouse_button(event.code));
+		break;
+		case kind::mouse_up:
+			program.mouse_up(event.position, mouse_button(event.code));
+		break;
+		case kind::mouse_move:
+			program.mouse_move(event.position, event.motion);
+		break;
+		case kind::quit:
+			program.end();
+		break;
+	}
+}
+
+#if defined SIMPLE_VG_RECORD
+// no window, sound or live input, just the drawing code with a fixed time step,
+// for SKETCH_FRAMES frames (600 by default), through the recording vg backend,
+// prints how long it took and what was drawn, per frame, as json
+//
+// with the rasterizing backend the frames are also drawn on the CPU,
+// using the sketch's own threads, and the last one is saved to
+// the png file SKETCH_SNAPSHOT names, if it's set
+//
+// SKETCH_REPLAY names an input log recorded with SKETCH_RECORD, each event
+// is handed over before the first frame that starts after it, counting frames
+// at the fixed time step, so a replay goes the same way every time,
+// however fast the recording went, and runs until the last event by default,
+// tiny_rand starts from the seed of the recording, and pressed() answers
+// from the keys the replay has down at the time
+int headless(Program& program)
+{
+	std::optional<common::input_log> replay;
+	if(const char* replay_file = std::getenv("SKETCH_REPLAY"))
+	{
+		replay = common::read_input_log(replay_file);
+		if(!replay)
+		{
+			std::fprintf(stderr, "couldn't read input log %s\n", replay_file);
+			return 1;
+		}
+	}
+
+	// no display to ask either, the window that was recorded is as good as any
+	program.display.size = replay ? int2(replay->width, replay->height) : program.size;
+	start(program);
+
+	auto canvas = vg::canvas(vg::canvas::flags::antialias | vg::canvas::flags::stencil_strokes);
+#if defined SIMPLE_VG_RASTER
+	raster::rasterizer rasterizer(canvas.recorder(), program.jobs);
+	const char* backend = "raster";
+#else
+	const char* backend = "record";
+#endif
+	canvas.clear();
+
+	program.create_framebuffers(canvas);
+	auto stolen_framebuffers = std::move(program.framebuffers);
+	const auto size = float2(program.fullscreen ? program.display.size : program.size);
+	program.draw_once(canvas.begin_frame(size));
+
+	const Program::duration delta_time = program.frametime.value_or(framerate<60>::frametime);
+	using microseconds = std::chrono::duration<double, std::micro>;
+	const auto frame_start_time = [delta_time](unsigned long frame)
+	{
+		return microseconds(delta_time).count() * frame;
+	};
+
+	const char* frames_variable = std::getenv("SKETCH_FRAMES");
+	unsigned long frames = 600;
+	if(frames_variable)
+		frames = std::strtoul(frames_variable, nullptr, 10);
+	else if(replay && !replay->events.empty())
+		frames = std::ceil(replay->events.back().time / frame_start_time(1)) + 1;
+
+	auto& stats = canvas.recorder().stats;
+	stats = {};
+	unsigned long drawn = 0;
+	std::size_t replayed = 0;
+	std::vector<double> frame_times;
+	frame_times.reserve(frames);
+	const auto start_time = Program::clock::now();
+	for(; drawn < frames && program.running(); ++drawn)
+	{
+		const auto frame_start = Program::clock::now();
+		if(replay)
+		{
+			const auto& events = replay->events;
+			for(; replayed < events.size() && events[replayed].time <= frame_start_time(drawn); ++replayed)
+				dispatch(program, events[replayed]);
+		}
+		canvas.clear();
+		program.draw_loop(canvas.begin_frame(size), delta_time);
+		frame_times.push_back(std::chrono::duration<double, std::milli>(Program::clock::now() - frame_start).count());
+	}
+	const auto elapsed = std::chrono::duration<double, std::milli>(Program::clock::now() - start_time);
+
+	// the slow frames are the ones that show, so the tail matters more than the average
+	std::sort(frame_times.begin(), frame_times.end());
+	const auto percentile = [&frame_times](double p)
+	{
+		return frame_times.empty() ? 0 : frame_times[std::size_t(p * (frame_times.size() - 1))];
+	};
+
+	const double per_frame = std::max(drawn, 1ul);
+	std::printf("{\"sketch\": \"%s\", \"backend\": \"%s\", \"frames\": %lu, \"ms_per_frame\": %.4f, "
+		"\"ms_p50\": %.4f, \"ms_p90\": %.4f, \"ms_p99\": %.4f, \"ms_max\": %.4f, \"replayed_events\": %zu, "
+		"\"draw_calls\": %.2f, \"fills\": %.2f, \"strokes\": %.2f, \"paths\": %.2f, \"vertices\": %.2f, "
+		"\"resets\": %.2f}\n",
+		program.argv[0], backend, drawn, elapsed.count() / per_frame,
+		percentile(.5), percentile(.9), percentile(.99), percentile(1), replayed,
+		stats.draw_calls() / per_frame, stats.fills / per_frame, stats.strokes / per_frame,
+		stats.paths / per_frame, stats.vertices / per_frame,
+		stats.resets / per_frame);
+
+#if defined SIMPLE_VG_RASTER
+	if(const char* snapshot = std::getenv("SKETCH_SNAPSHOT"))
+	{
+		const auto pixels = rasterizer.snapshot();
+		if(!common::write_png(snapshot, rasterizer.width(), rasterizer.height(), pixels.data()))
+		{
+			std::fprintf(stderr, "couldn't write %s\n", snapshot);
+			return 1;
+		}
+	}
+#endif
+	return 0;
+}
+#endif
+
 int main(int argc, char* argv[]) try
 {
 	Program program{argc, argv};
 
+#if defined SIMPLE_VG_RECORD
+	return headless(program);
+#else
+
 
 	graphical::initializer graphics;
 	program.display = (*graphics.displays().begin()).current_mode();
@@ -233,30 +432,7 @@ int main(int argc, char* argv[]) try
 
 			auto lock = std::scoped_lock(program.dam);
 			const auto tick = Program::duration(1.f/device.obtained().get_frequency());
-			std::transform(buffer.begin(), buffer.end(), buffer.begin(), [&program,&tick](auto v)
-			{
-				int8_t typed_v = 0;
-				memcpy(&typed_v, &v, 1);
-				float new_v = 0;
-
-				for(auto&& wave : program.waves)
-				{
-					if(wave && wave.remaining >= tick)
-					{
-						wave.remaining -= tick;
-						if(wave.remaining < tick)
-							wave.remaining = 0s;
-
-						new_v += wave.function(1.f - (wave.remaining.count()/wave.total.count())) * 127.f;
-					}
-				}
-				new_v = new_v + float(typed_v);
-				new_v = std::clamp(new_v, -127.f,127.f);
-
-				typed_v = new_v;
-				memcpy(&v, &typed_v, 1);
-				return v;
-			});
+			common::mix(program.waves, tick, buffer);
 		}
 	);
 	ocean.play();
@@ -293,6 +469,17 @@ int main(int argc, char* argv[]) try
 	glViewport(0,0, win.size().x(), win.size().y());
 	program.draw_once(canvas.begin_frame(float2(win.size())));
 
+	if(const char* record_file = std::getenv("SKETCH_RECORD"))
+	{
+		program.recorded_input.emplace(record_file, win.size().x(), win.size().y(), tiny_seed);
+		if(!*program.recorded_input)
+		{
+			std::fprintf(stderr, "couldn't write %s\n", record_file);
+			program.recorded_input.reset();
+		}
+		program.recording_start = Program::clock::now();
+	}
+
 	auto& now = Program::clock::now;
 	auto frame_start = now();
 	auto main_loop = [&]()
@@ -330,6 +517,7 @@ int main(int argc, char* argv[]) try
 #endif
 
 	return 0;
+#endif
 }
 catch(...)
 {
@@ -341,32 +529,44 @@ catch(...)
 void process_events(Program& program)
 {
 	using namespace interactive;
+	using kind = common::input_event::kind;
+	const auto handle = [&program](common::input_event event)
+	{
+		if(program.recorded_input)
+		{
+			event.time = std::chrono::duration_cast<std::chrono::microseconds>(
+				Program::clock::now() - program.recording_start).count();
+			program.recorded_input->record(event);
+		}
+		dispatch(program, event);
+	};
+
 	while(auto event = next_event()) std::visit(overloaded
 	{
-		[&program](const key_pressed& e)
+		[&handle](const key_pressed& e)
 		{
 			if(!e.data.repeat)
-				program.key_down(e.data.scancode, e.data.keycode);
+				handle({0, kind::key_down, std::int32_t(e.data.scancode), std::int32_t(e.data.keycode)});
 		},
-		[&program](const key_released& e)
+		[&handle](const key_released& e)
 		{
-			program.key_up(e.data.scancode, e.data.keycode);
+			handle({0, kind::key_up, std::int32_t(e.data.scancode), std::int32_t(e.data.keycode)});
 		},
-		[&program](const mouse_down& e)
+		[&handle](const mouse_down& e)
 		{
-			program.mouse_down(float2(e.data.position), e.data.button);
+			handle({0, kind::mouse_down, std::int32_t(e.data.button), 0, float2(e.data.position)});
 		},
-		[&program](const mouse_up& e)
+		[&handle](const mouse_up& e)
 		{
-			program.mouse_up(float2(e.data.position), e.data.button);
+			handle({0, kind::mouse_up, std::int32_t(e.data.button), 0, float2(e.data.position)});
 		},
-		[&program](const mouse_motion& e)
+		[&handle](const mouse_motion& e)
 		{
-			program.mouse_move(float2(e.data.position), float2(e.data.motion));
+			handle({0, kind::mouse_move, 0, 0, float2(e.data.position), float2(e.data.motion)});
 		},
-		[&program](const quit_request&)
+		[&handle](const quit_request&)
 		{
-			program.end();
+			handle({0, kind::quit});
 		},
 		[](const window_size_changed& w)
 		{
@@ -377,6 +577,9 @@ void process_events(Program& program)
 		},
 		[](auto) { }
 	}, *event);
+
+	if(program.recorded_input)
+		program.recorded_input->flush();
 }
 
 
@@ -0,0 +1,182 @@
+#ifndef COMMON_SPATIAL_HASH_HPP
+#define COMMON_SPATIAL_HASH_HPP
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <cmath>
+#include <algorithm>
+#include "simple/support.hpp"
+#include "simple/geom.hpp"
+#include "math.hpp"
+#include "particles.hpp"
+#include "parallel.hpp"
+
+namespace common
+{
+
+using namespace simple;
+
+// a uniform grid of buckets over a toroidal area, everything that leaves from
+// one side is expected to come back from the other, so queries near the edges
+// wrap around as well
+//
+// meant to be rebuilt from scratch every frame,
+// it's a counting sort of point indices by cell, so no per-cell allocations
+template <typename Value = float>
+class spatial_hash
+{
+	public:
+	using vector = geom::vector<Value,2>;
+	using index = geom::vector<int,2>;
+	using range = support::range<vector>;
+
+	spatial_hash(range bounds, Value cell_size) :
+		bounds(bounds),
+		resolution(max(index(ceil((bounds.upper() - bounds.lower()) / cell_size)), index::one())),
+		cell_size((bounds.upper() - bounds.lower()) / vector(resolution)),
+		counts(new std::atomic<unsigned>[cell_count()]),
+		offsets(cell_count() + 1)
+	{}
+
+	const range& get_bounds() const {return bounds;}
+
+	size_t cell_count() const
+	{
+		return size_t(resolution.x()) * resolution.y();
+	}
+
+	void build(const lanes<Value>& positions, thread_pool& jobs)
+	{
+		const size_t size = positions.x.size();
+		keys.resize(size);
+		items.resize(size);
+
+		jobs.parallel_for(0, cell_count(), [this](size_t first, size_t last)
+		{
+			for(size_t i = first; i < last; ++i)
+				counts[i].store(0, std::memory_order_relaxed);
+		});
+
+		jobs.parallel_for(0, size, [this, &positions](size_t first, size_t last)
+		{
+			for(size_t i = first; i < last; ++i)
+			{
+				keys[i] = key(wrap(cell_of({positions.x[i], positions.y[i]})));
+				counts[keys[i]].fetch_add(1, std::memory_order_relaxed);
+			}
+		});
+
+		offsets[0] = 0;
+		for(size_t cell = 0; cell < cell_count(); ++cell)
+		{
+			offsets[cell + 1] = offsets[cell] + counts[cell].load(std::memory_order_relaxed);
+			counts[cell].store(offsets[cell], std::memory_order_relaxed);
+		}
+
+		jobs.parallel_for(0, size, [this](size_t first, size_t last)
+		{
+			for(size_t i = first; i < last; ++i)
+				items[counts[keys[i]].fetch_add(1, std::memory_order_relaxed)] = i;
+		});
+	}
+
+	// visit(item, offset) for every item in the cells the circle touches,
+	// offset is what to add to the item's position to bring it
+	// to the same side of the wrap as the center,
+	// this only narrows things down, the caller does the precise test
+	template <typename Visitor>
+	void query(vector center, Value radius, Visitor&& visit) const
+	{
+		auto first = cell_of(center - radius);
+		auto last = cell_of(center + radius);
+		// a circle wider than the whole area would otherwise visit things twice
+		last.min(first + resolution - index::one());
+
+		for(int y = first.y(); y <= last.y(); ++y)
+			for(int x = first.x(); x <= last.x(); ++x)
+			{
+				const auto unwrapped = index(x,y);
+				const auto cell = wrap(unwrapped);
+				const auto offset = vector(unwrapped - cell) * cell_size;
+				const auto k = key(cell);
+				for(auto i = offsets[k]; i < offsets[k+1]; ++i)
+					visit(size_t(items[i]), offset);
+			}
+	}
+
+	// visit(item) for every item whose segment,
+	// from position - direction to position, intersects the circle,
+	// reach is the length of the longest segment
+	template <typename Visitor>
+	void query_segments(const lanes<Value>& positions, const lanes<Value>& directions, Value reach,
+		vector center, Value radius, Visitor&& visit) const
+	{
+		query(center, radius + reach, [&](size_t item, vector offset)
+		{
+			const auto end = positions[item] + offset;
+			const auto direction = directions[item];
+			if(segment_circle_intersects(end - direction, direction, center, radius))
+				visit(item);
+		});
+	}
+
+	// visit(item) for every circle of given radius that intersects the query circle
+	template <typename Visitor>
+	void query_circles(const lanes<Value>& positions, Value item_radius,
+		vector center, Value radius, Visitor&& visit) const
+	{
+		query(center, radius + item_radius, [&](size_t item, vector offset)
+		{
+			if(circles_intersect(positions[item] + offset, item_radius, center, radius))
+				visit(item);
+		});
+	}
+
+	private:
+	range bounds;
+	index resolution;
+	vector cell_size;
+
+	std::vector<unsigned> keys;
+	std::vector<unsigned> items;
+	std::unique_ptr<std::atomic<unsigned>[]> counts;
+	std::vector<unsigned> offsets;
+
+	static index max(index a, index b)
+	{
+		a.max(b);
+		return a;
+	}
+
+	static vector ceil(vector v)
+	{
+		return {std::ceil(v.x()), std::ceil(v.y())};
+	}
+
+	index cell_of(vector position) const
+	{
+		const auto cell = (position - bounds.lower()) / cell_size;
+		return {int(std::floor(cell.x())), int(std::floor(cell.y()))};
+	}
+
+	index wrap(index cell) const
+	{
+		// negative on the other side of the wrap
+		cell.x() %= resolution.x();
+		cell.y() %= resolution.y();
+		cell += resolution;
+		cell.x() %= resolution.x();
+		cell.y() %= resolution.y();
+		return cell;
+	}
+
+	unsigned key(index cell) const
+	{
+		return cell.y() * resolution.x() + cell.x();
+	}
+
+};
+
+} // namespace common
+
+#endif /* end of include guard */
@@ -0,0 +1,52 @@
+#ifndef COMMON_TERRAIN_HPP
+#define COMMON_TERRAIN_HPP
+#include <cstddef>
+#include "simple/support.hpp"
+
+namespace common
+{
+
+using namespace simple;
+
+// the smallest power of two plus one that is at least the given size, what midpoint_displacement works with
+constexpr std::size_t midpoint_size(std::size_t at_least)
+{
+	std::size_t size = 2;
+	while(size < at_least)
+		size = size * 2 - 1;
+	return size;
+}
+
+// fractal heights along a line, by midpoint displacement, in place, one level at a time,
+// each level puts a point halfway between every two neighbours of the previous one,
+// at their average, moved up or down by a random amount that shrinks by decay every level
+//
+// the heights need to be midpoint_size of something, with the two ends already set,
+// variations is scratch space for half as many, the random numbers of a level
+// are all drawn into it first, left to right, so that the loop over the level is
+// simple enough to get vectorized, and the order they are drawn in is the same as
+// inserting the points one by one would draw them
+//
+// random takes a range of floats and returns one within it
+template <typename Random>
+void midpoint_displacement(support::range<float*> heights, float displacement, float decay, Random&& random, float* variations)
+{
+	float* const height = heights.begin();
+	const std::size_t size = heights.end() - heights.begin();
+	for(std::size_t step = size - 1; step > 1; step /= 2)
+	{
+		const std::size_t count = (size - 1) / step;
+		for(std::size_t i = 0; i < count; ++i)
+			variations[i] = random({-1.f, 1.f});
+
+		const std::size_t half = step / 2;
+		for(std::size_t i = 0; i < count; ++i)
+			height[i * step + half] = (height[i * step] + height[i * step + step]) / 2 + variations[i] * displacement;
+
+		displacement *= decay;
+	}
+}
+
+} // namespace common
+
+#endif /* end of include guard */
@@ -1,65 +1,104 @@
 // based on: https://www.khanacademy.org/computer-programming/asteroid-game/1486828627
 
 // I, J, K, L to move, mouse to aim and shoot.
+// Optional arguments: two random seed numbers, and how many projectiles to make room for up front.
 
 #include "common/sketchbook.hpp"
+#include "common/particles.hpp"
+#include "common/spatial_hash.hpp"
 
 constexpr float light_speed = 40;
 constexpr float drag_factor = 0.1;
+constexpr float padding = 5;
 
-float2 drag(float2 velocity, float max_speed = light_speed, float factor = drag_factor)
-{
-	return factor * velocity/max_speed;
-}
-
-struct projectile
-{
-	float2 position = float2::zero();
-	float2 velocity = float2::zero();
-	float2 acceleration = float2::zero();
-
-	void move(Program::duration)
-	{
-		velocity += acceleration;
-		position += velocity;
-	}
-};
-
-struct line : public projectile
+struct lines : public common::particles<>
 {
 	float width = 1;
 	rgb color = rgb(0xff00ff_rgb);
+	float friction = drag_factor/light_speed;
 
-	void draw(vg::frame& frame)
+	void draw(vg::frame& frame) const
 	{
-		frame.begin_sketch()
-			.line(position - velocity, position)
-			.line_width(width)
-			.outline(color)
-		;
+		auto sketch = frame.begin_sketch();
+		for(size_t i = 0; i < size(); ++i)
+			sketch.line(position[i] - velocity[i], position[i]);
+		sketch.line_width(width).outline(color);
 	}
 
 };
 
-struct circle : public projectile
+struct circles : public common::particles<>
 {
 	float radius = 10;
 	rgb color = rgb(0xff00ff_rgb);
+	float friction = drag_factor/light_speed;
 
-	void draw(vg::frame& frame)
+	void draw(vg::frame& frame) const
 	{
-		frame.begin_sketch()
-			.ellipse(rect{radius * float2::one(), position, float2::one(0.5)})
-			.fill(color)
-		;
+		auto sketch = frame.begin_sketch();
+		for(size_t i = 0; i < size(); ++i)
+			sketch.ellipse(rect{radius * float2::one(), position[i], float2::one(0.5)});
+		sketch.fill(color);
 	}
 };
 
-using body = std::variant<line, circle>;
+template <typename Bodies>
+void update(Bodies& bodies, vg::frame& frame, common::thread_pool& jobs)
+{
+	const auto bounds = range2f{-float2::one(padding), frame.size + padding};
+
+	jobs.parallel_for(0, bodies.size(), [&bodies](size_t first, size_t last)
+	{
+		bodies.integrate({first, last});
+	});
+
+	bodies.draw(frame);
+
+	jobs.parallel_for(0, bodies.size(), [&bodies, &bounds](size_t first, size_t last)
+	{
+		bodies.drag(bodies.friction, {first, last});
+		bodies.wrap(bounds, {first, last});
+	});
+}
+
+lines projectiles;
+circles bodies;
+circles asteroids;
+
+circles::handle crc;
+
+std::optional<common::spatial_hash<>> projectile_grid;
+std::vector<size_t> hits;
+
+// projectiles hitting the asteroids push them and disappear
+void collide(common::thread_pool& jobs)
+{
+	constexpr float impact = 0.05f;
+
+	projectile_grid->build(projectiles.position, jobs);
 
-std::vector<body> bodies;
+	float reach = 0;
+	for(size_t i = 0; i < projectiles.size(); ++i)
+		reach = std::max(reach, quadrance(projectiles.velocity[i]));
+	reach = support::root2(reach);
 
-circle* crc = nullptr;
+	hits.clear();
+	for(size_t i = 0; i < asteroids.size(); ++i)
+	{
+		projectile_grid->query_segments(projectiles.position, projectiles.velocity, reach,
+			asteroids.position[i], asteroids.radius/2, [&](size_t hit)
+			{
+				hits.push_back(hit);
+				asteroids.velocity.set(i, asteroids.velocity[i] + projectiles.velocity[hit] * impact);
+			}
+		);
+	}
+
+	std::sort(hits.begin(), hits.end(), std::greater<>{});
+	hits.erase(std::unique(hits.begin(), hits.end()), hits.end());
+	for(auto&& hit : hits)
+		projectiles.erase(hit);
+}
 
 void start(Program& program)
 {
@@ -74,9 +113,18 @@ void start(Program& program)
 
 	std::cout << "seed: " << std::hex << std::showbase << tiny_rand << '\n';
 
-	bodies.push_back(circle{float2(program.size/2)});
-	bodies.reserve(10000);
-	crc = &std::get<circle>(bodies.back());
+	size_t capacity = 10000;
+	if(program.argc > 3)
+		capacity = support::ston<size_t>(program.argv[3]);
+	projectiles.reserve(capacity);
+
+	crc = bodies.push_back(float2(program.size/2));
+
+	asteroids.radius = 40;
+	asteroids.color = rgb(0x777777_rgb);
+	asteroids.friction = 0;
+	for(int i = 0; i < 7; ++i)
+		asteroids.push_back(trand_float2() * float2(program.size), trand_float2() - 0.5f);
 
 	program.key_up = [&](scancode code, keycode)
 	{
@@ -112,8 +160,8 @@ void start(Program& program)
 
 	program.mouse_down = [&](float2 position, auto)
 	{
-		if(bodies.size() < bodies.capacity())
-			bodies.push_back(line{crc->position, (position - crc->position) * 0.1f});
+		const auto origin = bodies.position[bodies.index(crc)];
+		projectiles.push_back(origin, (position - origin) * 0.1f);
 	};
 
 	program.draw_loop = [&](auto frame, auto delta_time)
@@ -123,29 +171,28 @@ void start(Program& program)
 			.fill(rgb::white(0))
 		;
 
-		crc->acceleration = float2::zero();
+		auto acceleration = float2::zero();
 		if(pressed(scancode::i))
-			crc->acceleration -= float2::j(0.1);
+			acceleration -= float2::j(0.1);
 		if(pressed(scancode::k))
-			crc->acceleration += float2::j(0.1);
+			acceleration += float2::j(0.1);
 		if(pressed(scancode::j))
-			crc->acceleration -= float2::i(0.1);
+			acceleration -= float2::i(0.1);
 		if(pressed(scancode::l))
-			crc->acceleration += float2::i(0.1);
+			acceleration += float2::i(0.1);
+		bodies.acceleration.set(bodies.index(crc), acceleration);
 
-		for(auto&& body : bodies)
-		{
-			std::visit( [&frame, &delta_time] (auto& body)
-			{
-				body.move(delta_time);
-				body.draw(frame);
-				body.velocity -= drag(body.velocity);
-				constexpr float padding = 5;
-				auto fullsize = frame.size + 2 * padding;
-				body.position = ((fullsize + (body.position + padding)) % fullsize) - padding;
-			}, body);
-		}
-		std::cout << std::dec << "Size: " << bodies.size() << " FPS: " << 1/delta_time.count() << '\n';
+		update(asteroids, frame, program.jobs);
+		update(bodies, frame, program.jobs);
+		update(projectiles, frame, program.jobs);
+
+		// same area as the wrap, which changes with the window
+		const auto wrap_bounds = range2f{-float2::one(padding), frame.size + padding};
+		if(!projectile_grid || projectile_grid->get_bounds().upper() != wrap_bounds.upper())
+			projectile_grid.emplace(wrap_bounds, 32);
+		collide(program.jobs);
+
+		std::cout << std::dec << "Size: " << asteroids.size() + bodies.size() + projectiles.size() << " FPS: " << 1/delta_time.count() << '\n';
 	};
 
 }
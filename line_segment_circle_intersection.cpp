@@ -143,9 +143,7 @@ void start(Program& program)
 		const float2 center = c.center - l.start;
 		const float2 center_projection = project(center, l.direction);
 		const float2 center_rejection = center - center_projection;
-		const bool projection_in_segment = range{0.f, l.direction[0]}.fix().contains(center_projection[0]);
-		const bool line_in_circle = (center_rejection).magnitude() < c.magnitude();
-		const bool poke_check = c.contains(l.start) || c.contains(l.start + l.direction);
+		const bool intersects = common::segment_circle_intersects(l.start, l.direction, c.center, c.radius);
 
 		frame.begin_sketch()
 			.rectangle(rect{ frame.size })
@@ -154,7 +152,7 @@ void start(Program& program)
 
 		frame.begin_sketch()
 			.ellipse(range2f(c))
-			.fill(poke_check || (projection_in_segment && line_in_circle) ? 0x00aa00_rgb : 0xaaaaaa_rgb)
+			.fill(intersects ? 0x00aa00_rgb : 0xaaaaaa_rgb)
 		;
 
 		arrow(frame.begin_sketch(), l.start, l.start + l.direction)
@@ -1,6 +1,7 @@
 // based on: https://www.khanacademy.org/computer-programming/starry-night-sky-o_o/1545831539
 
 #include "common/sketchbook.hpp"
+#include "common/terrain.hpp"
 
 int stars = 100;
 float hstart = 300.f;  // left edge mountain height
@@ -10,6 +11,10 @@ float r = 100; //mountain random range
 float moon_radius = 50;
 float2 moon_area = float2(1.f, 0.5f);
 
+// kept from one draw to the next, to only allocate once
+std::vector<float> peaks;
+std::vector<float> peak_variations;
+
 rgb skyColorFrom (rgb24(0_u8, 0_u8, 51_u8)),
 	skyColorTo (rgb24(51_u8, 51_u8, 51_u8));
 
@@ -93,31 +98,23 @@ void start(Program& program)
 		}
 
 		// generate mountains
-		std::vector peaks = {hstart, hend};
-		auto rng = r;
-		while(peaks.size() < frame.size.x() + 113)
-		{
-			for(size_t i = 0; i < peaks.size(); i += 2)
-			{
-				const float variation = trand_float({-1.f, 1.f}) * rng;
-				const float height = (peaks[i] + peaks[i+1])/2 + variation;
-				peaks.insert(peaks.begin() + i + 1, height);
-			}
-			rng = rng * std::pow(2,-h);
-		}
-
-		// draw mountains
+		const auto size = common::midpoint_size(frame.size.x() + 113);
+		peaks.resize(size);
+		peak_variations.resize(size / 2);
+		peaks.front() = hstart;
+		peaks.back() = hend;
+		common::midpoint_displacement(make_range(peaks.data(), peaks.data() + size),
+			r, std::pow(2.f,-h), trand_float, peak_variations.data());
+
+		// draw mountains, as one shape down to the bottom edge
 		{ auto mountain_sketch = frame.begin_sketch();
 
-			for(size_t i = 0; i < frame.size.x(); ++i)
-				mountain_sketch.line(
-					{float(i), peaks[i]},
-					{float(i), frame.size.y()} );
+			mountain_sketch.move({0.f, frame.size.y()});
+			for(size_t i = 0; i <= frame.size.x(); ++i)
+				mountain_sketch.vertex({float(i), peaks[i]});
+			mountain_sketch.vertex(frame.size);
 
-			mountain_sketch
-				.line_width(2)
-				.outline(rgb::white(0));
-			;
+			mountain_sketch.fill(rgb::white(0));
 		}
 
 	};
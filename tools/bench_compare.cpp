@@ -0,0 +1,67 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <map>
+#include <cstdlib>
+
+using namespace std;
+
+// reads the json lines the benchmarks print, just enough to get the medians
+map<string, double> medians(const char* filename)
+{
+	ifstream file(filename);
+	if(!file)
+	{
+		cerr << "can't read " << filename << '\n';
+		exit(2);
+	}
+
+	map<string, double> result;
+	const string name_key = "{\"name\": \"";
+	const string median_key = "\"median\": ";
+	string line;
+	while(getline(file, line))
+	{
+		if(line.compare(0, name_key.size(), name_key) != 0)
+			continue;
+		const auto name_end = line.find('"', name_key.size());
+		const auto median = line.find(median_key);
+		if(name_end == string::npos || median == string::npos)
+			continue;
+		result[line.substr(name_key.size(), name_end - name_key.size())] =
+			atof(line.c_str() + median + median_key.size());
+	}
+	return result;
+}
+
+int main(int argc, char** argv)
+{
+	if(argc < 3)
+	{
+		cerr << "usage: bench_compare <baseline.json> <current.json> [threshold percent = 10]" << '\n';
+		return 2;
+	}
+
+	const auto baseline = medians(argv[1]);
+	const auto current = medians(argv[2]);
+	const double threshold = argc > 3 ? atof(argv[3]) : 10;
+
+	bool regressed = false;
+	for(auto&& [name, median] : current)
+	{
+		const auto old = baseline.find(name);
+		if(old == baseline.end())
+		{
+			cout << name << ": new, " << median << " ns" << '\n';
+			continue;
+		}
+		const double change = (median / old->second - 1) * 100;
+		const bool slower = change > threshold;
+		regressed = regressed || slower;
+		cout << name << ": " << old->second << " -> " << median << " ns ("
+			<< (change > 0 ? "+" : "") << change << "%)"
+			<< (slower ? " REGRESSION" : "") << '\n';
+	}
+
+	return regressed ? 1 : 0;
+}